@@ -0,0 +1,391 @@
+//==============================================================================
+/*
+    Yibo Wen, Ching-Chih Chen
+*/
+//==============================================================================
+//
+// Micro/macro benchmarks of the cloth stack, written in the JSON format of
+// Google Benchmark so that results can be compared with its tools.
+//
+// Build with the application sources except main.cpp, then run:
+//     clothBench [--benchmark_out=file.json] [--benchmark_min_time=sec]
+//
+//------------------------------------------------------------------------------
+#include "../cloth.h"
+#include "../clothContact.h"
+#include "../clothXPBD.h"
+#include "../clothImplicit.h"
+#include "../clothSelfCollision.h"
+#include "../clothMeshCollision.h"
+#include "../clothMesh.h"
+#include "../clothSkin.h"
+#include "../tripleBuffer.h"
+//------------------------------------------------------------------------------
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <sstream>
+#include <string>
+#include <vector>
+//------------------------------------------------------------------------------
+using namespace chai3d;
+using namespace std;
+//------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+// DECLARED TYPES
+//------------------------------------------------------------------------------
+
+// timing of one benchmark
+struct cBenchResult
+{
+    string m_name;
+    long m_iterations;
+    double m_realTime;  // [us] per iteration
+    double m_cpuTime;   // [us] per iteration
+    double m_speedup;   // against the serial run of the same benchmark, 0 if none
+};
+
+//------------------------------------------------------------------------------
+// DECLARED VARIABLES
+//------------------------------------------------------------------------------
+
+// minimum measuring time of a benchmark [s]
+double minTime = 0.5;
+
+// all results
+vector<cBenchResult> results;
+
+// grid sizes, in nodes per side
+const int gridSizes[] = { 21, 41, 64, 128, 256 };
+
+// thread counts of the parallel solver benchmark
+const int threadCounts[] = { 2, 4, 8, 16, 32 };
+
+//------------------------------------------------------------------------------
+// DECLARED FUNCTIONS
+//------------------------------------------------------------------------------
+
+// run a_function with an increasing number of iterations until it took at least minTime
+template <class F>
+void runBenchmark(const string& a_name, F a_function)
+{
+    cPrecisionClock clock;
+    long iterations = 1;
+    double realTime = 0.0;
+    double cpuTime = 0.0;
+
+    while (true)
+    {
+        clock_t cpuStart = std::clock();
+        clock.start(true);
+        for (long i = 0; i < iterations; i++)
+        {
+            a_function();
+        }
+        realTime = clock.stop();
+        cpuTime = (double)(std::clock() - cpuStart) / CLOCKS_PER_SEC;
+
+        if ((realTime >= minTime) || (iterations >= 1000000000L))
+        {
+            break;
+        }
+
+        // aim directly for the minimum time, at most 10 times more iterations
+        double factor = (realTime > 0.0) ? 1.4 * minTime / realTime : 10.0;
+        long next = (long)(iterations * cMin(10.0, cMax(2.0, factor)));
+        iterations = next;
+    }
+
+    cBenchResult result;
+    result.m_name = a_name;
+    result.m_iterations = iterations;
+    result.m_realTime = 1e6 * realTime / iterations;
+    result.m_cpuTime = 1e6 * cpuTime / iterations;
+    result.m_speedup = 0.0;
+    results.push_back(result);
+
+    printf("%-32s %14.2f us %14.2f us %12ld\n", a_name.c_str(), result.m_realTime, result.m_cpuTime, iterations);
+    fflush(stdout);
+}
+
+//------------------------------------------------------------------------------
+
+// name of a benchmark for a given grid size
+string benchName(const char* a_name, int a_size)
+{
+    ostringstream name;
+    name << a_name << "/" << a_size;
+    return (name.str());
+}
+
+//------------------------------------------------------------------------------
+
+// delete skeleton nodes and links created by cClothModel::buildSkeleton()
+void destroySkeleton(cGELMesh* a_mesh)
+{
+    for (list<cGELSkeletonNode*>::iterator i = a_mesh->m_nodes.begin(); i != a_mesh->m_nodes.end(); ++i)
+    {
+        delete *i;
+    }
+    for (list<cGELSkeletonLink*>::iterator i = a_mesh->m_links.begin(); i != a_mesh->m_links.end(); ++i)
+    {
+        delete *i;
+    }
+    a_mesh->m_nodes.clear();
+    a_mesh->m_links.clear();
+}
+
+//------------------------------------------------------------------------------
+
+// write all results in the Google Benchmark JSON format
+bool writeJSON(const string& a_filename)
+{
+    FILE* file = fopen(a_filename.c_str(), "w");
+    if (file == NULL)
+    {
+        return (false);
+    }
+
+    char date[64];
+    time_t now = time(NULL);
+    strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", localtime(&now));
+
+    fprintf(file, "{\n");
+    fprintf(file, "  \"context\": {\n");
+    fprintf(file, "    \"date\": \"%s\",\n", date);
+    fprintf(file, "    \"executable\": \"clothBench\",\n");
+#if defined(NDEBUG)
+    fprintf(file, "    \"library_build_type\": \"release\"\n");
+#else
+    fprintf(file, "    \"library_build_type\": \"debug\"\n");
+#endif
+    fprintf(file, "  },\n");
+    fprintf(file, "  \"benchmarks\": [\n");
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        const cBenchResult& r = results[i];
+        fprintf(file, "    {\n");
+        fprintf(file, "      \"name\": \"%s\",\n", r.m_name.c_str());
+        fprintf(file, "      \"run_name\": \"%s\",\n", r.m_name.c_str());
+        fprintf(file, "      \"run_type\": \"iteration\",\n");
+        fprintf(file, "      \"iterations\": %ld,\n", r.m_iterations);
+        fprintf(file, "      \"real_time\": %.6f,\n", r.m_realTime);
+        fprintf(file, "      \"cpu_time\": %.6f,\n", r.m_cpuTime);
+        if (r.m_speedup > 0.0)
+        {
+            fprintf(file, "      \"speedup\": %.6f,\n", r.m_speedup);
+        }
+        fprintf(file, "      \"time_unit\": \"us\"\n");
+        fprintf(file, "    }%s\n", (i + 1 < results.size()) ? "," : "");
+    }
+    fprintf(file, "  ]\n");
+    fprintf(file, "}\n");
+    fclose(file);
+
+    return (true);
+}
+
+//==============================================================================
+
+int main(int argc, char* argv[])
+{
+    string outputFile;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strncmp(argv[i], "--benchmark_out=", 16) == 0)
+        {
+            outputFile = argv[i] + 16;
+        }
+        else if (strncmp(argv[i], "--benchmark_min_time=", 21) == 0)
+        {
+            minTime = atof(argv[i] + 21);
+        }
+    }
+
+    printf("%-32s %17s %17s %12s\n", "Benchmark", "Time", "CPU", "Iterations");
+    printf("-------------------------------------------------------------------------------\n");
+
+    for (size_t g = 0; g < sizeof(gridSizes) / sizeof(gridSizes[0]); g++)
+    {
+        int size = gridSizes[g];
+
+        cClothParams params;
+        params.numX = size - 1;
+        params.numY = size - 1;
+
+        //----------------------------------------------------------------------
+        // initCloth()
+        //----------------------------------------------------------------------
+
+        cClothModel cloth(params);
+        runBenchmark(benchName("BM_InitCloth", size), [&]() { cloth.initCloth(); });
+
+        //----------------------------------------------------------------------
+        // GEL skeleton construction
+        //----------------------------------------------------------------------
+
+        cGELMesh skeletonMesh;
+        runBenchmark(benchName("BM_BuildSkeleton", size), [&]()
+        {
+            cloth.buildSkeleton(&skeletonMesh);
+            destroySkeleton(&skeletonMesh);
+        });
+
+        //----------------------------------------------------------------------
+        // one dynamics step
+        //----------------------------------------------------------------------
+
+        cGELWorld* defWorld = new cGELWorld();
+        cGELMesh* defObject = new cGELMesh();
+        defWorld->m_gelMeshes.push_front(defObject);
+        defObject->buildVertices();
+        defObject->m_useSkeletonModel = true;
+        cloth.buildSkeleton(defObject);
+        defObject->connectVerticesToSkeleton(true);
+
+        runBenchmark(benchName("BM_UpdateDynamics", size), [&]() { defWorld->updateDynamics(0.001); });
+
+        // same step with the flat-array position based solver
+        {
+            cClothModel xpbdCloth(params);
+            cXPBDClothSolver xpbd(&xpbdCloth);
+            runBenchmark(benchName("BM_XPBDStep", size), [&]() { xpbd.step(0.001); });
+            double serialTime = results.back().m_realTime;
+
+            // colored constraints on a thread pool, up to the number of cores
+            int numCores = (int)std::thread::hardware_concurrency();
+            for (size_t t = 0; t < sizeof(threadCounts) / sizeof(threadCounts[0]); t++)
+            {
+                if (threadCounts[t] > numCores)
+                {
+                    break;
+                }
+
+                cThreadPool pool(threadCounts[t]);
+                xpbd.setThreadPool(&pool);
+                ostringstream name;
+                name << "BM_XPBDStepParallel/" << size << "/threads:" << threadCounts[t];
+                runBenchmark(name.str(), [&]() { xpbd.step(0.001); });
+                xpbd.setThreadPool(NULL);
+
+                cBenchResult& result = results.back();
+                result.m_speedup = serialTime / result.m_realTime;
+                printf("%-32s %14.2fx\n", "  speedup", result.m_speedup);
+            }
+        }
+
+        // backward Euler step with the CG iteration cap of the parameters
+        {
+            cClothModel implicitCloth(params);
+            cImplicitClothSolver implicit(&implicitCloth);
+            runBenchmark(benchName("BM_ImplicitStep", size), [&]() { implicit.step(0.001); });
+        }
+
+        // XPBD step followed by a self-collision pass
+        {
+            cClothModel selfCloth(params);
+            selfCloth.initCloth();
+            cXPBDClothSolver xpbd(&selfCloth);
+            cSelfCollider selfCollider;
+            double spacing = params.size / params.numX;
+            selfCollider.setup(selfCloth.m_indices, 2.0 * spacing, 0.25 * spacing);
+            xpbd.addCollider(&selfCollider);
+            runBenchmark(benchName("BM_SelfCollisionStep", size), [&]() { xpbd.step(0.001); });
+        }
+
+        // XPBD step with the cloth resting on a sphere
+        {
+            cClothModel meshCloth(params);
+            meshCloth.initCloth();
+            cXPBDClothSolver xpbd(&meshCloth);
+            cMesh sphere;
+            cCreateSphere(&sphere, 0.15, 32, 32);
+            sphere.setLocalPos(0.0, params.height - 0.15, 0.0);
+            cMeshCollider meshCollider;
+            meshCollider.setup(meshCloth.m_indices, 0.005);
+            meshCollider.addObstacle(&sphere, 0.01);
+            xpbd.addCollider(&meshCollider);
+            runBenchmark(benchName("BM_MeshCollisionStep", size), [&]() { xpbd.step(0.001); });
+        }
+
+        //----------------------------------------------------------------------
+        // contact loop: tool pressing on the cloth center
+        //----------------------------------------------------------------------
+
+        cGELClothSolver solver(defWorld, &cloth);
+        cToolContact toolContact;
+        toolContact.setup(&cloth, 0.1, params.nodeRadius, 100.0);
+        cVector3d toolPos(0.0, params.height + 0.05, 0.0);
+
+        cTripleBuffer<cClothSnapshot> snapshots;
+        runBenchmark(benchName("BM_ContactLoop", size), [&]()
+        {
+            solver.clearExternalForces();
+            cVector3d force = toolContact.computeForces(toolPos);
+            toolContact.applyForces(&solver);
+            cloth.updatePositions();
+            toolContact.updateBroadPhase();
+            cloth.writeSnapshot(snapshots.getWriteBuffer());
+            snapshots.publish();
+            (void)force;
+        });
+
+        //----------------------------------------------------------------------
+        // contact of a 30 primitive hand resting on the cloth center
+        //----------------------------------------------------------------------
+
+        cToolShape hand;
+        cCreateToolShape("hand", 0.1, hand);
+        cToolContact handContact;
+        handContact.setup(&cloth, hand, params.nodeRadius, 100.0);
+        cVector3d torque;
+        runBenchmark(benchName("BM_ToolContactHand", size), [&]()
+        {
+            solver.clearExternalForces();
+            cVector3d force = handContact.computeForces(toolPos, cIdentity3d(), torque);
+            handContact.applyForces(&solver);
+            (void)force;
+        });
+
+        //----------------------------------------------------------------------
+        // per-frame vertex copy
+        //----------------------------------------------------------------------
+
+        cMesh renderObject;
+        cClothRenderMesh renderMesh;
+        renderMesh.create(&renderObject, cloth.m_X, cloth.m_indices);
+        cClothSnapshot snapshot;
+        cloth.writeSnapshot(snapshot);
+
+        runBenchmark(benchName("BM_VertexCopy", size), [&]() { renderMesh.update(snapshot.m_X); });
+
+        //----------------------------------------------------------------------
+        // per-frame skin evaluation, four render cells per cloth cell side
+        //----------------------------------------------------------------------
+
+        cMesh skinObject;
+        cClothSkin skin;
+        skin.create(&skinObject, cloth.getNumNodesX(), cloth.getNumNodesY(), 4, cloth.m_X);
+        runBenchmark(benchName("BM_SkinUpdate", size), [&]() { skin.update(snapshot.m_X); });
+
+        // same on the default number of graphics threads
+        cThreadPool skinPool(2);
+        skin.setThreadPool(&skinPool);
+        ostringstream skinName;
+        skinName << "BM_SkinUpdateParallel/" << size << "/threads:2";
+        runBenchmark(skinName.str(), [&]() { skin.update(snapshot.m_X); });
+        skin.setThreadPool(NULL);
+
+        destroySkeleton(defObject);
+        delete defWorld;
+    }
+
+    if (!outputFile.empty() && !writeJSON(outputFile))
+    {
+        printf("failed to write %s\n", outputFile.c_str());
+        return (1);
+    }
+
+    return (0);
+}
@@ -5,61 +5,155 @@
 #include "cloth.h"
 
 //------------------------------------------------------------------------------
-// DECLARED GRAPHICS VARIABLES
+using namespace chai3d;
 //------------------------------------------------------------------------------
 
-// grid size
-int numX = 20, numY = 20;
-size_t total_points = (numX + 1) * (numY + 1);
-float fullsize = 4.0f;
-float halfsize = fullsize / 2.0f;
-
-int selected_index = -1;
-
-std::vector<GLushort> indices;
-
-std::vector<glm::vec3> X;
+cClothModel::cClothModel(const cClothParams& a_params)
+{
+    m_params = a_params;
+    m_params.numX = cMax(1, m_params.numX);
+    m_params.numY = cMax(1, m_params.numY);
+}
 
-int oldX = 0, oldY = 0;
+//------------------------------------------------------------------------------
 
-GLint viewport[4];
-GLdouble MV[16];
-GLdouble P[16];
+cVector3d cClothModel::getRestPos(int a_x, int a_y) const
+{
+    double halfsize = 0.5 * m_params.size;
+    return cVector3d(-halfsize + m_params.size * (double)a_x / (double)m_params.numX,
+                     m_params.height,
+                     -halfsize + m_params.size * (double)a_y / (double)m_params.numY);
+}
 
 //------------------------------------------------------------------------------
 
-void initCloth() {
+void cClothModel::initCloth() {
 
     int i = 0, j = 0, count = 0;
-    int v = numY + 1;
-    int u = numX + 1;
+    int numX = m_params.numX;
+    int numY = m_params.numY;
+    int v = getNumNodesY();
+    int u = getNumNodesX();
 
-    indices.resize(numX * numY * 2 * 3);
-    X.resize(total_points);
+    m_X.resize(getNumNodes());
 
     // fill in X
     for (j = 0; j < v; j++) {
         for (i = 0; i < u; i++) {
-            X[count++] = glm::vec3(((float(i) / (u - 1)) * 2 - 1) * halfsize / 5, -0.2f, ((float(j) / (v - 1)) * 2 - 1) * halfsize / 5);
+            cVector3d p = getRestPos(i, j);
+            m_X[count++] = glm::vec3((float)p.x(), (float)p.y(), (float)p.z());
         }
     }
 
     // fill in indices
-    GLushort* id = &indices[0];
-    for (i = 0; i < numY; i++) {
-        for (j = 0; j < numX; j++) {
-            int i0 = i * (numX + 1) + j;
-            int i1 = i0 + 1;
-            int i2 = i0 + (numX + 1);
-            int i3 = i2 + 1;
-            if ((j + i) % 2) {
-                *id++ = i0; *id++ = i2; *id++ = i1;
-                *id++ = i1; *id++ = i2; *id++ = i3;
+    m_indices.buildGrid(numX, numY);
+}
+
+//------------------------------------------------------------------------------
+
+void cClothModel::buildSkeleton(cGELMesh* a_mesh)
+{
+    // set default properties for skeleton nodes
+    cGELSkeletonNode::s_default_radius = m_params.nodeRadius;
+    cGELSkeletonNode::s_default_kDampingPos = m_params.kDampingPos;
+    cGELSkeletonNode::s_default_kDampingRot = m_params.kDampingRot;
+    cGELSkeletonNode::s_default_mass = m_params.nodeMass;
+    cGELSkeletonNode::s_default_useGravity = true;
+    cGELSkeletonNode::s_default_gravity.set(0.0, m_params.gravity, 0.0);
+
+    // set default physical properties for links
+    cGELSkeletonLink::s_default_kSpringElongation = m_params.kSpringElongation;
+    cGELSkeletonLink::s_default_kSpringFlexion = m_params.kSpringFlexion;
+    cGELSkeletonLink::s_default_kSpringTorsion = m_params.kSpringTorsion;
+
+    // create an array of nodes
+    m_nodes.resize(getNumNodes());
+    for (int y = 0; y < getNumNodesY(); y++)
+    {
+        for (int x = 0; x < getNumNodesX(); x++)
+        {
+            cGELSkeletonNode* newNode = new cGELSkeletonNode();
+            a_mesh->m_nodes.push_front(newNode);
+            newNode->m_pos = getRestPos(x, y);
+            newNode->m_fixed = isPinned(x, y);
+            m_nodes[getNodeIndex(x, y)] = newNode;
+        }
+    }
+
+    // create links between nodes
+    buildLinks();
+    for (size_t i = 0; i < m_links.size(); i++)
+    {
+        cGELSkeletonLink* newLink = new cGELSkeletonLink(m_nodes[m_links[i].m_node0], m_nodes[m_links[i].m_node1]);
+        a_mesh->m_links.push_front(newLink);
+    }
+
+    updatePositions();
+}
+
+//------------------------------------------------------------------------------
+
+void cClothModel::buildLinks()
+{
+    int numX = m_params.numX;
+    int numY = m_params.numY;
+
+    m_links.clear();
+    for (int y = 0; y < numY; y++)
+    {
+        for (int x = 0; x < numX; x++)
+        {
+            cClothLink linkX0 = { getNodeIndex(x + 0, y + 0), getNodeIndex(x + 1, y + 0) };
+            cClothLink linkY0 = { getNodeIndex(x + 0, y + 0), getNodeIndex(x + 0, y + 1) };
+            m_links.push_back(linkX0);
+            m_links.push_back(linkY0);
+
+            // close the grid along the last row and column
+            if (y == numY - 1)
+            {
+                cClothLink linkX1 = { getNodeIndex(x + 0, y + 1), getNodeIndex(x + 1, y + 1) };
+                m_links.push_back(linkX1);
             }
-            else {
-                *id++ = i0; *id++ = i2; *id++ = i3;
-                *id++ = i0; *id++ = i3; *id++ = i1;
+            if (x == numX - 1)
+            {
+                cClothLink linkY1 = { getNodeIndex(x + 1, y + 0), getNodeIndex(x + 1, y + 1) };
+                m_links.push_back(linkY1);
             }
         }
     }
-}
\ No newline at end of file
+}
+
+//------------------------------------------------------------------------------
+
+void cClothModel::updatePositions()
+{
+    int numNodes = (int)m_nodes.size();
+    m_px.resize(numNodes);
+    m_py.resize(numNodes);
+    m_pz.resize(numNodes);
+
+    for (int i = 0; i < numNodes; i++)
+    {
+        const cVector3d& pos = m_nodes[i]->m_pos;
+        m_px[i] = pos(0);
+        m_py[i] = pos(1);
+        m_pz[i] = pos(2);
+    }
+}
+
+//------------------------------------------------------------------------------
+
+void cClothModel::writeSnapshot(cClothSnapshot& a_snapshot) const
+{
+    int numNodes = (int)m_px.size();
+    a_snapshot.m_X.resize(numNodes);
+
+    // render mesh is drawn slightly above the skeleton
+    glm::vec3* X = &a_snapshot.m_X[0];
+    for (int i = 0; i < numNodes; i++)
+    {
+        X[i].x = (float)m_px[i];
+        X[i].y = (float)(m_py[i] + C_CLOTH_RENDER_OFFSET);
+        X[i].z = (float)m_pz[i];
+    }
+}
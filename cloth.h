@@ -3,6 +3,8 @@
 #include "chai3d.h"
 #include "GEL3D.h"
 
+#include "clothIndices.h"
+
 #include <GLFW/glfw3.h>
 #include <vector>
 #include <glm/glm.hpp>
@@ -10,8 +12,135 @@
 #include <glm/gtc/type_ptr.hpp>
 
 //------------------------------------------------------------------------------
-// DECLARED GRAPHICS FUNCTIONS
+// DECLARED TYPES
 //------------------------------------------------------------------------------
 
-// initialize scene
-void initCloth();
\ No newline at end of file
+// height of the render positions above the skeleton nodes [m]
+const double C_CLOTH_RENDER_OFFSET = 0.01;
+
+// runtime parameters of the cloth grid
+struct cClothParams
+{
+    // number of grid cells along x and z, the grid has (numX + 1) * (numY + 1) nodes
+    int numX = 20;
+    int numY = 20;
+
+    // edge length of the (square) cloth [m]
+    double size = 0.8;
+
+    // initial height of the cloth [m]
+    double height = -0.2;
+
+    // node properties
+    double nodeRadius = 0.018;      // [m]
+    double nodeMass = 0.0004;       // [kg]
+    double kDampingPos = 10.0;
+    double kDampingRot = 0.6;
+    double gravity = -9.81;         // [m/s^2]
+
+    // link properties
+    double kSpringElongation = 25.0;    // [N/m]
+    double kSpringFlexion = 0.000005;   // [Nm/RAD]
+    double kSpringTorsion = 0.5;        // [Nm/RAD]
+
+    // position based solver properties
+    int solverIterations = 8;
+    double bendCompliance = 0.5;        // [m/N]
+    double velocityDamping = 2.0;       // [1/s]
+
+    // implicit solver properties
+    int cgMaxIterations = 30;
+    double cgTolerance = 1e-4;          // relative residual
+};
+
+// node positions published by the simulation for rendering
+struct cClothSnapshot
+{
+    // simulation tick at which the positions were taken
+    unsigned long long m_tick;
+
+    // render positions
+    std::vector<glm::vec3> m_X;
+};
+
+// structural link between two nodes, stored as node indices
+struct cClothLink
+{
+    int m_node0;
+    int m_node1;
+};
+
+//------------------------------------------------------------------------------
+
+// cloth model: owns the grid resolution, the skeleton nodes, the link
+// topology and the render buffers, so that all of them are built from the
+// same set of parameters.
+class cClothModel
+{
+public:
+
+    // constructor
+    cClothModel(const cClothParams& a_params);
+
+    // fill in render positions and triangle indices
+    void initCloth();
+
+    // build the structural link topology, each edge of the grid is linked exactly once
+    void buildLinks();
+
+    // create skeleton nodes and links inside a deformable mesh, using the
+    // node and link properties of the parameters
+    void buildSkeleton(chai3d::cGELMesh* a_mesh);
+
+    // copy skeleton node positions into the position arrays
+    void updatePositions();
+
+    // copy the position arrays into the render positions of a snapshot
+    void writeSnapshot(cClothSnapshot& a_snapshot) const;
+
+    // number of nodes along x
+    int getNumNodesX() const { return m_params.numX + 1; }
+
+    // number of nodes along z
+    int getNumNodesY() const { return m_params.numY + 1; }
+
+    // total number of nodes
+    int getNumNodes() const { return getNumNodesX() * getNumNodesY(); }
+
+    // index of node (x, y) inside the node and render arrays
+    int getNodeIndex(int a_x, int a_y) const { return a_y * getNumNodesX() + a_x; }
+
+    // node at grid position (x, y), only valid after buildSkeleton()
+    chai3d::cGELSkeletonNode* getNode(int a_x, int a_y) const { return m_nodes[getNodeIndex(a_x, a_y)]; }
+
+    // rest position of node (x, y)
+    chai3d::cVector3d getRestPos(int a_x, int a_y) const;
+
+    // true if node (x, y) is held in place (the four corners)
+    bool isPinned(int a_x, int a_y) const
+    {
+        return (((a_x == 0) || (a_x == m_params.numX)) && ((a_y == 0) || (a_y == m_params.numY)));
+    }
+
+public:
+
+    // grid parameters
+    cClothParams m_params;
+
+    // skeleton nodes (owned by the deformable mesh)
+    std::vector<chai3d::cGELSkeletonNode*> m_nodes;
+
+    // node positions as contiguous x/y/z arrays, refreshed by updatePositions()
+    std::vector<double> m_px;
+    std::vector<double> m_py;
+    std::vector<double> m_pz;
+
+    // structural links
+    std::vector<cClothLink> m_links;
+
+    // render triangle indices
+    cClothIndices m_indices;
+
+    // render positions
+    std::vector<glm::vec3> m_X;
+};
@@ -0,0 +1,304 @@
+//------------------------------------------------------------------------------
+#include "clothBVH.h"
+//------------------------------------------------------------------------------
+#include <algorithm>
+#include <cmath>
+//------------------------------------------------------------------------------
+using namespace chai3d;
+//------------------------------------------------------------------------------
+
+cClothBVH::cClothBVH()
+{
+}
+
+//------------------------------------------------------------------------------
+
+void cClothBVH::build(const cClothIndices& a_indices, const double* a_x, const double* a_y, const double* a_z)
+{
+    int numTriangles = (int)(a_indices.size() / 3);
+    m_triangles.resize(3 * numTriangles);
+    for (int i = 0; i < 3 * numTriangles; i++)
+    {
+        m_triangles[i] = (int)a_indices[i];
+    }
+
+    // triangle centers drive the splits
+    std::vector<double> centers(3 * numTriangles);
+    const double* pos[3] = { a_x, a_y, a_z };
+    for (int t = 0; t < numTriangles; t++)
+    {
+        for (int k = 0; k < 3; k++)
+        {
+            centers[3 * t + k] = (pos[k][m_triangles[3 * t + 0]] + pos[k][m_triangles[3 * t + 1]] +
+                                  pos[k][m_triangles[3 * t + 2]]) / 3.0;
+        }
+    }
+
+    m_order.resize(numTriangles);
+    for (int t = 0; t < numTriangles; t++)
+    {
+        m_order[t] = t;
+    }
+
+    m_nodes.clear();
+    m_nodes.reserve(2 * numTriangles / C_LEAF_SIZE + 2);
+    m_nodes.push_back(cBVHNode());
+    split(0, 0, numTriangles, centers);
+
+    refit(a_x, a_y, a_z);
+}
+
+//------------------------------------------------------------------------------
+
+void cClothBVH::split(int a_node, int a_first, int a_count, const std::vector<double>& a_centers)
+{
+    m_nodes[a_node].m_first = a_first;
+    m_nodes[a_node].m_count = a_count;
+    m_nodes[a_node].m_child = -1;
+    if (a_count <= C_LEAF_SIZE)
+    {
+        return;
+    }
+
+    // split at the median center along the longest side of the center box
+    double lower[3] = { 1e30, 1e30, 1e30 };
+    double upper[3] = { -1e30, -1e30, -1e30 };
+    for (int i = a_first; i < a_first + a_count; i++)
+    {
+        for (int k = 0; k < 3; k++)
+        {
+            lower[k] = std::min(lower[k], a_centers[3 * m_order[i] + k]);
+            upper[k] = std::max(upper[k], a_centers[3 * m_order[i] + k]);
+        }
+    }
+    int axis = 0;
+    for (int k = 1; k < 3; k++)
+    {
+        if (upper[k] - lower[k] > upper[axis] - lower[axis])
+        {
+            axis = k;
+        }
+    }
+
+    int half = a_count / 2;
+    std::nth_element(m_order.begin() + a_first, m_order.begin() + a_first + half, m_order.begin() + a_first + a_count,
+        [&](int a, int b) { return (a_centers[3 * a + axis] < a_centers[3 * b + axis]); });
+
+    int child = (int)m_nodes.size();
+    m_nodes.push_back(cBVHNode());
+    m_nodes.push_back(cBVHNode());
+    m_nodes[a_node].m_child = child;
+    m_nodes[a_node].m_count = 0;
+    split(child, a_first, half, a_centers);
+    split(child + 1, a_first + half, a_count - half, a_centers);
+}
+
+//------------------------------------------------------------------------------
+
+void cClothBVH::refit(const double* a_x, const double* a_y, const double* a_z)
+{
+    const double* pos[3] = { a_x, a_y, a_z };
+
+    // children are stored after their parent, so a reverse sweep visits
+    // every child before its parent
+    for (int n = (int)m_nodes.size() - 1; n >= 0; n--)
+    {
+        cBVHNode& node = m_nodes[n];
+        if (node.m_child < 0)
+        {
+            for (int k = 0; k < 3; k++)
+            {
+                node.m_min[k] = 1e30;
+                node.m_max[k] = -1e30;
+            }
+            for (int i = node.m_first; i < node.m_first + node.m_count; i++)
+            {
+                const int* tri = &m_triangles[3 * m_order[i]];
+                for (int j = 0; j < 3; j++)
+                {
+                    for (int k = 0; k < 3; k++)
+                    {
+                        double p = pos[k][tri[j]];
+                        node.m_min[k] = std::min(node.m_min[k], p);
+                        node.m_max[k] = std::max(node.m_max[k], p);
+                    }
+                }
+            }
+        }
+        else
+        {
+            const cBVHNode& left = m_nodes[node.m_child];
+            const cBVHNode& right = m_nodes[node.m_child + 1];
+            for (int k = 0; k < 3; k++)
+            {
+                node.m_min[k] = std::min(left.m_min[k], right.m_min[k]);
+                node.m_max[k] = std::max(left.m_max[k], right.m_max[k]);
+            }
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+
+int cClothBVH::query(const cVector3d& a_min, const cVector3d& a_max, std::vector<int>& a_result) const
+{
+    a_result.clear();
+    if (m_nodes.empty())
+    {
+        return (0);
+    }
+
+    // the tree is balanced, its depth is the log of the number of leaves
+    int stack[64];
+    int size = 0;
+    stack[size++] = 0;
+    while (size > 0)
+    {
+        const cBVHNode& node = m_nodes[stack[--size]];
+        if ((node.m_max[0] < a_min(0)) || (node.m_min[0] > a_max(0)) ||
+            (node.m_max[1] < a_min(1)) || (node.m_min[1] > a_max(1)) ||
+            (node.m_max[2] < a_min(2)) || (node.m_min[2] > a_max(2)))
+        {
+            continue;
+        }
+
+        if (node.m_child < 0)
+        {
+            for (int i = node.m_first; i < node.m_first + node.m_count; i++)
+            {
+                a_result.push_back(m_order[i]);
+            }
+        }
+        else
+        {
+            stack[size++] = node.m_child;
+            stack[size++] = node.m_child + 1;
+        }
+    }
+    return ((int)a_result.size());
+}
+
+//------------------------------------------------------------------------------
+
+double cClothBVH::enterBox(int a_node, const double* a_origin, const double* a_invDir, double a_maxDistance) const
+{
+    // slab test, an infinite inverse direction gives infinite slabs
+    const cBVHNode& node = m_nodes[a_node];
+    double enter = 0.0;
+    double exit = a_maxDistance;
+    for (int k = 0; k < 3; k++)
+    {
+        double t0 = (node.m_min[k] - a_origin[k]) * a_invDir[k];
+        double t1 = (node.m_max[k] - a_origin[k]) * a_invDir[k];
+        enter = std::max(enter, std::min(t0, t1));
+        exit = std::min(exit, std::max(t0, t1));
+    }
+    return ((enter <= exit) ? enter : -1.0);
+}
+
+//------------------------------------------------------------------------------
+
+bool cClothBVH::raycast(const cVector3d& a_origin, const cVector3d& a_dir, double a_maxDistance,
+    const double* a_x, const double* a_y, const double* a_z, cClothRayHit& a_hit) const
+{
+    a_hit.m_triangle = -1;
+    a_hit.m_distance = a_maxDistance;
+    if (m_nodes.empty())
+    {
+        return (false);
+    }
+
+    double origin[3] = { a_origin(0), a_origin(1), a_origin(2) };
+    double invDir[3];
+    for (int k = 0; k < 3; k++)
+    {
+        invDir[k] = 1.0 / a_dir(k);
+    }
+
+    // nearer child first, boxes entered past the closest hit are skipped
+    int stack[64];
+    double enter[64];
+    int size = 0;
+    enter[size] = enterBox(0, origin, invDir, a_hit.m_distance);
+    stack[size++] = 0;
+    while (size > 0)
+    {
+        size--;
+        if ((enter[size] < 0.0) || (enter[size] > a_hit.m_distance))
+        {
+            continue;
+        }
+        const cBVHNode& node = m_nodes[stack[size]];
+
+        if (node.m_child >= 0)
+        {
+            double near0 = enterBox(node.m_child, origin, invDir, a_hit.m_distance);
+            double near1 = enterBox(node.m_child + 1, origin, invDir, a_hit.m_distance);
+            bool swap = (near1 >= 0.0) && ((near0 < 0.0) || (near1 < near0));
+            stack[size] = swap ? node.m_child : node.m_child + 1;
+            enter[size++] = swap ? near0 : near1;
+            stack[size] = swap ? node.m_child + 1 : node.m_child;
+            enter[size++] = swap ? near1 : near0;
+            continue;
+        }
+
+        // Moller-Trumbore test of the triangles in the leaf
+        for (int i = node.m_first; i < node.m_first + node.m_count; i++)
+        {
+            const int* tri = &m_triangles[3 * m_order[i]];
+            cVector3d p0(a_x[tri[0]], a_y[tri[0]], a_z[tri[0]]);
+            cVector3d e1 = cVector3d(a_x[tri[1]], a_y[tri[1]], a_z[tri[1]]) - p0;
+            cVector3d e2 = cVector3d(a_x[tri[2]], a_y[tri[2]], a_z[tri[2]]) - p0;
+            cVector3d p = cCross(a_dir, e2);
+            double det = cDot(e1, p);
+            if (fabs(det) < 1e-14)
+            {
+                continue;
+            }
+            double invDet = 1.0 / det;
+            cVector3d s = a_origin - p0;
+            double u = cDot(s, p) * invDet;
+            if ((u < 0.0) || (u > 1.0))
+            {
+                continue;
+            }
+            cVector3d q = cCross(s, e1);
+            double v = cDot(a_dir, q) * invDet;
+            if ((v < 0.0) || (u + v > 1.0))
+            {
+                continue;
+            }
+            double t = cDot(e2, q) * invDet;
+            if ((t >= 0.0) && (t < a_hit.m_distance))
+            {
+                a_hit.m_triangle = m_order[i];
+                a_hit.m_distance = t;
+                a_hit.m_u = u;
+                a_hit.m_v = v;
+            }
+        }
+    }
+    return (a_hit.m_triangle >= 0);
+}
+
+//------------------------------------------------------------------------------
+
+cVector3d cClothBVH::getBoundaryMin() const
+{
+    if (m_nodes.empty())
+    {
+        return (cVector3d(0.0, 0.0, 0.0));
+    }
+    return (cVector3d(m_nodes[0].m_min[0], m_nodes[0].m_min[1], m_nodes[0].m_min[2]));
+}
+
+//------------------------------------------------------------------------------
+
+cVector3d cClothBVH::getBoundaryMax() const
+{
+    if (m_nodes.empty())
+    {
+        return (cVector3d(0.0, 0.0, 0.0));
+    }
+    return (cVector3d(m_nodes[0].m_max[0], m_nodes[0].m_max[1], m_nodes[0].m_max[2]));
+}
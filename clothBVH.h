@@ -0,0 +1,94 @@
+#pragma once
+
+#include "chai3d.h"
+#include "clothIndices.h"
+
+#include <vector>
+
+//------------------------------------------------------------------------------
+// DECLARED TYPES
+//------------------------------------------------------------------------------
+
+// closest hit of a ray on the cloth: triangle, distance along the ray and
+// barycentric weights of the second and third node of the triangle
+struct cClothRayHit
+{
+    int m_triangle;
+    double m_distance;
+    double m_u;
+    double m_v;
+};
+
+//------------------------------------------------------------------------------
+
+// bounding volume hierarchy over the cloth triangles. the tree is built once
+// by median splits and only refitted afterwards: leaf boxes are recomputed
+// from the node positions and parents are merged bottom-up, which is linear in
+// the number of triangles. the cloth topology never changes, so a refitted
+// tree stays valid, only looser than a rebuilt one.
+class cClothBVH
+{
+public:
+
+    // constructor
+    cClothBVH();
+
+    // build the tree over the triangles of a_indices at the given node positions
+    void build(const cClothIndices& a_indices, const double* a_x, const double* a_y, const double* a_z);
+
+    // recompute all boxes from new node positions
+    void refit(const double* a_x, const double* a_y, const double* a_z);
+
+    // collect the triangles whose box overlaps [a_min, a_max]
+    int query(const chai3d::cVector3d& a_min, const chai3d::cVector3d& a_max, std::vector<int>& a_result) const;
+
+    // closest triangle hit by the ray from a_origin along a_dir within
+    // a_maxDistance, at node positions a_x/y/z, returns false on a miss.
+    // both sides of the cloth are hit.
+    bool raycast(const chai3d::cVector3d& a_origin, const chai3d::cVector3d& a_dir, double a_maxDistance,
+        const double* a_x, const double* a_y, const double* a_z, cClothRayHit& a_hit) const;
+
+    // number of triangles
+    int getNumTriangles() const { return (int)(m_triangles.size() / 3); }
+
+    // the three nodes of triangle a_index
+    const int* getTriangle(int a_index) const { return (&m_triangles[3 * a_index]); }
+
+    // box of the whole cloth at the last refit
+    chai3d::cVector3d getBoundaryMin() const;
+    chai3d::cVector3d getBoundaryMax() const;
+
+protected:
+
+    // split the triangles m_order[a_first .. a_first + a_count] below node a_node
+    void split(int a_node, int a_first, int a_count, const std::vector<double>& a_centers);
+
+    // distance at which the ray enters the box of node a_node, or a negative
+    // value if it misses the box before a_maxDistance
+    double enterBox(int a_node, const double* a_origin, const double* a_invDir, double a_maxDistance) const;
+
+protected:
+
+    // tree node. the children of an inner node are m_child and m_child + 1,
+    // a leaf holds m_order[m_first .. m_first + m_count]
+    struct cBVHNode
+    {
+        double m_min[3];
+        double m_max[3];
+        int m_child;
+        int m_first;
+        int m_count;
+    };
+
+    // most triangles in a leaf
+    enum { C_LEAF_SIZE = 4 };
+
+    // triangle nodes, three per triangle
+    std::vector<int> m_triangles;
+
+    // triangles in leaf order
+    std::vector<int> m_order;
+
+    // tree nodes, children are always stored after their parent
+    std::vector<cBVHNode> m_nodes;
+};
@@ -0,0 +1,107 @@
+//------------------------------------------------------------------------------
+#include "clothCollision.h"
+//------------------------------------------------------------------------------
+#include <algorithm>
+#include <cmath>
+//------------------------------------------------------------------------------
+using namespace chai3d;
+//------------------------------------------------------------------------------
+
+cTableCollider::cTableCollider()
+{
+    m_height = 0.0;
+    m_margin = 0.0;
+    m_minX = m_maxX = 0.0;
+    m_minZ = m_maxZ = 0.0;
+    m_staticFriction = 0.0;
+    m_dynamicFriction = 0.0;
+    m_numContacts = 0;
+    m_deepestNode = -1;
+    m_maxPenetration = 0.0;
+}
+
+//------------------------------------------------------------------------------
+
+void cTableCollider::setup(cMesh* a_table, double a_margin)
+{
+    a_table->computeBoundaryBox(true);
+    cVector3d lower = a_table->getLocalPos() + a_table->getBoundaryMin();
+    cVector3d upper = a_table->getLocalPos() + a_table->getBoundaryMax();
+
+    m_height = upper(1);
+    m_margin = a_margin;
+    m_minX = lower(0);
+    m_maxX = upper(0);
+    m_minZ = lower(2);
+    m_maxZ = upper(2);
+    m_staticFriction = a_table->m_material->getStaticFriction();
+    m_dynamicFriction = a_table->m_material->getDynamicFriction();
+}
+
+//------------------------------------------------------------------------------
+
+int cTableCollider::collide(const cClothCollisionState& a_state)
+{
+    m_numContacts = 0;
+    m_deepestNode = -1;
+    m_maxPenetration = 0.0;
+
+    // cheap bounding check: nothing to do while the lowest node is above the top
+    int numNodes = a_state.m_numNodes;
+    const double* y = a_state.m_y;
+    double limit = m_height + m_margin;
+    double lowest = limit;
+    for (int i = 0; i < numNodes; i++)
+    {
+        lowest = std::min(lowest, y[i]);
+    }
+    if (lowest >= limit)
+    {
+        return (0);
+    }
+
+    for (int i = 0; i < numNodes; i++)
+    {
+        double penetration = limit - a_state.m_y[i];
+        if ((penetration <= 0.0) || a_state.m_pinned[i])
+        {
+            continue;
+        }
+
+        // off the table
+        double x = a_state.m_x[i];
+        double z = a_state.m_z[i];
+        if ((x < m_minX) || (x > m_maxX) || (z < m_minZ) || (z > m_maxZ))
+        {
+            continue;
+        }
+
+        // project onto the top
+        a_state.m_y[i] = limit;
+
+        // friction against the motion along the top during the step
+        double dx = x - a_state.m_x0[i];
+        double dz = z - a_state.m_z0[i];
+        double slide = sqrt(dx * dx + dz * dz);
+        if (slide <= m_staticFriction * penetration)
+        {
+            a_state.m_x[i] = a_state.m_x0[i];
+            a_state.m_z[i] = a_state.m_z0[i];
+        }
+        else
+        {
+            double s = std::min(1.0, m_dynamicFriction * penetration / slide);
+            a_state.m_x[i] = x - s * dx;
+            a_state.m_z[i] = z - s * dz;
+        }
+
+        m_numContacts++;
+        if (penetration > m_maxPenetration)
+        {
+            m_maxPenetration = penetration;
+            m_deepestNode = i;
+        }
+    }
+
+    return (m_numContacts);
+}
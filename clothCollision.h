@@ -0,0 +1,100 @@
+#pragma once
+
+#include "chai3d.h"
+
+//------------------------------------------------------------------------------
+// DECLARED TYPES
+//------------------------------------------------------------------------------
+
+// node positions handed to the collision stages at the end of a solver step
+struct cClothCollisionState
+{
+    // number of nodes
+    int m_numNodes;
+
+    // positions at the end of the step, corrected in place
+    double* m_x;
+    double* m_y;
+    double* m_z;
+
+    // positions at the start of the step
+    const double* m_x0;
+    const double* m_y0;
+    const double* m_z0;
+
+    // 1 for nodes held in place, which must not be moved
+    const char* m_pinned;
+
+    // step length [s]
+    double m_dt;
+};
+
+//------------------------------------------------------------------------------
+
+// collision stage of the cloth step. a stage moves the end of step positions
+// out of an obstacle; the solver then derives the node velocities from the
+// corrected positions.
+class cClothCollider
+{
+public:
+
+    // destructor
+    virtual ~cClothCollider() {}
+
+    // resolve contacts, returns the number of nodes in contact
+    virtual int collide(const cClothCollisionState& a_state) = 0;
+};
+
+//------------------------------------------------------------------------------
+
+// horizontal rectangular table top. nodes below the top are projected back
+// onto it, and their motion along the top during the step is reduced by
+// Coulomb friction: it is cancelled while shorter than the static friction
+// coefficient times the penetration, and shortened by the dynamic friction
+// coefficient times the penetration otherwise.
+class cTableCollider : public cClothCollider
+{
+public:
+
+    // constructor
+    cTableCollider();
+
+    // take the top, extent and friction of a_table, which must be horizontal
+    // and unrotated. nodes are kept a_margin above the top.
+    void setup(chai3d::cMesh* a_table, double a_margin);
+
+    // resolve contacts
+    virtual int collide(const cClothCollisionState& a_state);
+
+    // number of nodes in contact at the last collide()
+    int getNumContacts() const { return (m_numContacts); }
+
+    // deepest node of the last collide(), -1 if none
+    int getDeepestNode() const { return (m_deepestNode); }
+
+    // penetration of the deepest node [m]
+    double getMaxPenetration() const { return (m_maxPenetration); }
+
+public:
+
+    // height of the top, nodes are kept above m_height + m_margin [m]
+    double m_height;
+    double m_margin;
+
+    // extent of the top along x and z [m]
+    double m_minX;
+    double m_maxX;
+    double m_minZ;
+    double m_maxZ;
+
+    // friction coefficients
+    double m_staticFriction;
+    double m_dynamicFriction;
+
+protected:
+
+    // statistics of the last collide()
+    int m_numContacts;
+    int m_deepestNode;
+    double m_maxPenetration;
+};
@@ -0,0 +1,173 @@
+//------------------------------------------------------------------------------
+#include "clothContact.h"
+//------------------------------------------------------------------------------
+#include <algorithm>
+using namespace chai3d;
+//------------------------------------------------------------------------------
+
+cToolContact::cToolContact()
+{
+    m_nodeRadius = 0.0;
+    m_stiffness = 0.0;
+    m_cloth = NULL;
+    m_numCandidates = 0;
+}
+
+//------------------------------------------------------------------------------
+
+void cToolContact::setup(cClothModel* a_cloth, double a_toolRadius, double a_nodeRadius, double a_stiffness)
+{
+    cToolShape shape;
+    shape.addSphere(cVector3d(0.0, 0.0, 0.0), a_toolRadius);
+    setup(a_cloth, shape, a_nodeRadius, a_stiffness);
+}
+
+//------------------------------------------------------------------------------
+
+void cToolContact::setup(cClothModel* a_cloth, const cToolShape& a_shape, double a_nodeRadius, double a_stiffness)
+{
+    m_cloth = a_cloth;
+    m_shape = a_shape;
+    m_nodeRadius = a_nodeRadius;
+    m_stiffness = a_stiffness;
+
+    // one cell covers the contact distance of the thickest primitive
+    int numNodes = m_cloth->getNumNodes();
+    m_hash.setup(numNodes, m_shape.getFeatureSize(m_nodeRadius));
+    updateBroadPhase();
+
+    m_candidates.reserve(numNodes);
+    m_batch.resize(numNodes);
+    m_batch.resize(0);
+    m_touched.clear();
+    m_touched.reserve(numNodes);
+    m_slot.assign(numNodes, -1);
+    m_force.clear();
+    m_force.reserve(numNodes);
+    m_numCandidates = 0;
+}
+
+//------------------------------------------------------------------------------
+
+cVector3d cToolContact::computeForces(const cVector3d& a_toolPos)
+{
+    cVector3d torque;
+    return (computeForces(a_toolPos, cIdentity3d(), torque));
+}
+
+//------------------------------------------------------------------------------
+
+cVector3d cToolContact::computeForces(const cVector3d& a_toolPos, const cMatrix3d& a_toolRot, cVector3d& a_torque)
+{
+    // forget the nodes of the previous call
+    for (size_t t = 0; t < m_touched.size(); t++)
+    {
+        m_slot[m_touched[t]] = -1;
+    }
+    m_touched.clear();
+    m_force.clear();
+    m_numCandidates = 0;
+
+    cVector3d force(0.0, 0.0, 0.0);
+    a_torque.zero();
+
+    int numPrimitives = m_shape.getNumPrimitives();
+    for (int p = 0; p < numPrimitives; p++)
+    {
+        // primitive in world coordinates and its bounding box
+        const cToolPrimitive& primitive = m_shape.getPrimitive(p);
+        double contactRadius = primitive.m_radius + m_nodeRadius;
+        cVector3d pos = a_toolPos + a_toolRot * primitive.m_pos;
+        cVector3d end = a_toolPos + a_toolRot * primitive.m_end;
+        cMatrix3d rot = a_toolRot * primitive.m_rot;
+        cVector3d lower, upper;
+        for (int k = 0; k < 3; k++)
+        {
+            double extent = contactRadius + fabs(rot(k, 0)) * primitive.m_halfSize(0) +
+                fabs(rot(k, 1)) * primitive.m_halfSize(1) + fabs(rot(k, 2)) * primitive.m_halfSize(2);
+            lower(k) = std::min(pos(k), end(k)) - extent;
+            upper(k) = std::max(pos(k), end(k)) + extent;
+        }
+
+        // gather the nodes selected by the broad phase
+        int numCandidates = m_hash.query(lower, upper, m_candidates);
+        m_numCandidates += numCandidates;
+        if (numCandidates == 0)
+        {
+            continue;
+        }
+        m_batch.resize(numCandidates);
+        for (int c = 0; c < numCandidates; c++)
+        {
+            int i = m_candidates[c];
+            m_batch.m_index[c] = i;
+            m_batch.m_x[c] = m_cloth->m_px[i];
+            m_batch.m_y[c] = m_cloth->m_py[i];
+            m_batch.m_z[c] = m_cloth->m_pz[i];
+        }
+
+        // compute reaction forces
+        if (primitive.m_type == C_TOOL_SPHERE)
+        {
+            force += cComputeContactForces(m_batch, pos, contactRadius, m_stiffness);
+        }
+        else if (primitive.m_type == C_TOOL_CAPSULE)
+        {
+            force += cComputeCapsuleContactForces(m_batch, pos, end, contactRadius, m_stiffness);
+        }
+        else
+        {
+            force += cComputeBoxContactForces(m_batch, pos, rot, primitive.m_halfSize, contactRadius, m_stiffness);
+        }
+
+        // sum node forces, the tool takes the opposite force at each node
+        for (int c = 0; c < numCandidates; c++)
+        {
+            cVector3d f(m_batch.m_fx[c], m_batch.m_fy[c], m_batch.m_fz[c]);
+            if (f.lengthsq() == 0.0)
+            {
+                continue;
+            }
+            int i = m_batch.m_index[c];
+            if (m_slot[i] < 0)
+            {
+                m_slot[i] = (int)m_touched.size();
+                m_touched.push_back(i);
+                m_force.push_back(cVector3d(0.0, 0.0, 0.0));
+            }
+            m_force[m_slot[i]] += f;
+            cVector3d arm(m_batch.m_x[c] - a_toolPos(0), m_batch.m_y[c] - a_toolPos(1), m_batch.m_z[c] - a_toolPos(2));
+            a_torque -= cCross(arm, f);
+        }
+    }
+
+    return (force);
+}
+
+//------------------------------------------------------------------------------
+
+int cToolContact::countContacts() const
+{
+    return ((int)m_touched.size());
+}
+
+//------------------------------------------------------------------------------
+
+void cToolContact::applyForces(cClothSolver* a_solver)
+{
+    for (size_t t = 0; t < m_touched.size(); t++)
+    {
+        a_solver->addExternalForce(m_touched[t], m_force[t]);
+    }
+}
+
+//------------------------------------------------------------------------------
+
+void cToolContact::updateBroadPhase()
+{
+    int numNodes = m_cloth->getNumNodes();
+    for (int i = 0; i < numNodes; i++)
+    {
+        m_hash.update(i, cVector3d(m_cloth->m_px[i], m_cloth->m_py[i], m_cloth->m_pz[i]));
+    }
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "clothSolver.h"
+#include "spatialHash.h"
+#include "contactKernel.h"
+#include "toolShape.h"
+
+#include <vector>
+
+//------------------------------------------------------------------------------
+// DECLARED TYPES
+//------------------------------------------------------------------------------
+
+// contact between a tool made of primitives and the cloth nodes: for each
+// primitive a broad phase query over the node positions followed by the
+// batched penalty kernel on the candidates. forces of a node touched by
+// several primitives add up.
+class cToolContact
+{
+public:
+
+    // constructor
+    cToolContact();
+
+    // index the nodes of a cloth model for a spherical tool
+    void setup(cClothModel* a_cloth, double a_toolRadius, double a_nodeRadius, double a_stiffness);
+
+    // index the nodes of a cloth model for a tool of shape a_shape
+    void setup(cClothModel* a_cloth, const cToolShape& a_shape, double a_nodeRadius, double a_stiffness);
+
+    // compute node forces for a tool at a_toolPos, returns the force on the tool
+    chai3d::cVector3d computeForces(const chai3d::cVector3d& a_toolPos);
+
+    // compute node forces for a tool at a_toolPos with orientation a_toolRot,
+    // returns the force on the tool and its torque about a_toolPos in a_torque
+    chai3d::cVector3d computeForces(const chai3d::cVector3d& a_toolPos, const chai3d::cMatrix3d& a_toolRot,
+        chai3d::cVector3d& a_torque);
+
+    // add the node forces of the last computeForces() to the cloth solver
+    void applyForces(cClothSolver* a_solver);
+
+    // move nodes that changed cell since the last update, call after the
+    // cloth model positions have been refreshed
+    void updateBroadPhase();
+
+    // number of candidates tested by the last computeForces(), over all primitives
+    int getNumCandidates() const { return m_numCandidates; }
+
+    // number of nodes in contact after the last computeForces()
+    int countContacts() const;
+
+public:
+
+    // contact parameters
+    cToolShape m_shape;
+    double m_nodeRadius;
+    double m_stiffness;
+
+protected:
+
+    // cloth model
+    cClothModel* m_cloth;
+
+    // broad phase over node positions
+    cSpatialHash m_hash;
+
+    // nodes selected by the broad phase for one primitive
+    std::vector<int> m_candidates;
+
+    // positions and forces of the candidate nodes of one primitive
+    cContactBatch m_batch;
+
+    // candidates tested by the last computeForces()
+    int m_numCandidates;
+
+    // nodes touched by the last computeForces(), and their summed forces,
+    // indexed by node through m_slot (-1 when untouched)
+    std::vector<int> m_touched;
+    std::vector<int> m_slot;
+    std::vector<chai3d::cVector3d> m_force;
+};
@@ -0,0 +1,393 @@
+//------------------------------------------------------------------------------
+#include "clothImplicit.h"
+//------------------------------------------------------------------------------
+#include <algorithm>
+#include <cmath>
+//------------------------------------------------------------------------------
+using namespace chai3d;
+//------------------------------------------------------------------------------
+
+// dot product of two CG vectors
+static double dot(const std::vector<double>& a_a, const std::vector<double>& a_b)
+{
+    double sum = 0.0;
+    size_t n = a_a.size();
+    for (size_t i = 0; i < n; i++)
+    {
+        sum += a_a[i] * a_b[i];
+    }
+    return (sum);
+}
+
+//------------------------------------------------------------------------------
+
+cImplicitClothSolver::cImplicitClothSolver(cClothModel* a_cloth) : cClothSolver(a_cloth)
+{
+    m_h = 0.0;
+    m_damping = 0.0;
+    m_lastIterations = 0;
+    m_lastResidual = 0.0;
+
+    // node state, starting at rest
+    const cClothParams& params = m_cloth->m_params;
+    int numNodes = m_cloth->getNumNodes();
+    m_x.resize(3 * numNodes);
+    m_v.assign(3 * numNodes, 0.0);
+    m_external.assign(3 * numNodes, 0.0);
+    m_force.assign(3 * numNodes, 0.0);
+    m_mass.assign(numNodes, params.nodeMass);
+    for (int y = 0; y < m_cloth->getNumNodesY(); y++)
+    {
+        for (int x = 0; x < m_cloth->getNumNodesX(); x++)
+        {
+            int i = m_cloth->getNodeIndex(x, y);
+            cVector3d pos = m_cloth->getRestPos(x, y);
+            m_x[3 * i + 0] = pos(0);
+            m_x[3 * i + 1] = pos(1);
+            m_x[3 * i + 2] = pos(2);
+        }
+    }
+
+    m_cloth->m_px.resize(numNodes);
+    m_cloth->m_py.resize(numNodes);
+    m_cloth->m_pz.resize(numNodes);
+    m_nx.resize(numNodes);
+    m_ny.resize(numNodes);
+    m_nz.resize(numNodes);
+    for (int i = 0; i < numNodes; i++)
+    {
+        m_cloth->m_px[i] = m_x[3 * i + 0];
+        m_cloth->m_py[i] = m_x[3 * i + 1];
+        m_cloth->m_pz[i] = m_x[3 * i + 2];
+    }
+
+    // stretch springs on the structural links
+    m_cloth->buildLinks();
+    for (size_t i = 0; i < m_cloth->m_links.size(); i++)
+    {
+        addSpring(m_cloth->m_links[i].m_node0, m_cloth->m_links[i].m_node1, params.kSpringElongation);
+    }
+
+    // bending springs across two cells, as stiff as the XPBD bending constraints
+    double kBend = 1.0 / params.bendCompliance;
+    for (int y = 0; y < m_cloth->getNumNodesY(); y++)
+    {
+        for (int x = 0; x < m_cloth->getNumNodesX(); x++)
+        {
+            if (x + 2 < m_cloth->getNumNodesX())
+            {
+                addSpring(m_cloth->getNodeIndex(x, y), m_cloth->getNodeIndex(x + 2, y), kBend);
+            }
+            if (y + 2 < m_cloth->getNumNodesY())
+            {
+                addSpring(m_cloth->getNodeIndex(x, y), m_cloth->getNodeIndex(x, y + 2), kBend);
+            }
+        }
+    }
+
+    m_springDir.resize(3 * m_springRest.size());
+    m_springTransverse.resize(m_springRest.size());
+
+    m_dv.assign(3 * numNodes, 0.0);
+    m_rhs.resize(3 * numNodes);
+    m_r.resize(3 * numNodes);
+    m_z.resize(3 * numNodes);
+    m_p.resize(3 * numNodes);
+    m_q.resize(3 * numNodes);
+    m_diag.resize(3 * numNodes);
+}
+
+//------------------------------------------------------------------------------
+
+void cImplicitClothSolver::addSpring(int a_node0, int a_node1, double a_stiffness)
+{
+    double dx = m_x[3 * a_node1 + 0] - m_x[3 * a_node0 + 0];
+    double dy = m_x[3 * a_node1 + 1] - m_x[3 * a_node0 + 1];
+    double dz = m_x[3 * a_node1 + 2] - m_x[3 * a_node0 + 2];
+
+    m_spring0.push_back(a_node0);
+    m_spring1.push_back(a_node1);
+    m_springRest.push_back(sqrt(dx * dx + dy * dy + dz * dz));
+    m_springK.push_back(a_stiffness);
+}
+
+//------------------------------------------------------------------------------
+
+void cImplicitClothSolver::clearExternalForces()
+{
+    std::fill(m_external.begin(), m_external.end(), 0.0);
+}
+
+//------------------------------------------------------------------------------
+
+void cImplicitClothSolver::addExternalForce(int a_node, const cVector3d& a_force)
+{
+    m_external[3 * a_node + 0] += a_force(0);
+    m_external[3 * a_node + 1] += a_force(1);
+    m_external[3 * a_node + 2] += a_force(2);
+}
+
+//------------------------------------------------------------------------------
+
+void cImplicitClothSolver::computeForces()
+{
+    const cClothParams& params = m_cloth->m_params;
+    int numNodes = (int)m_mass.size();
+
+    // gravity, external forces and damping
+    for (int i = 0; i < numNodes; i++)
+    {
+        double m = m_mass[i];
+        m_force[3 * i + 0] = m_external[3 * i + 0] - m_damping * m * m_v[3 * i + 0];
+        m_force[3 * i + 1] = m_external[3 * i + 1] - m_damping * m * m_v[3 * i + 1] + m * params.gravity;
+        m_force[3 * i + 2] = m_external[3 * i + 2] - m_damping * m * m_v[3 * i + 2];
+    }
+
+    // springs
+    int numSprings = (int)m_springRest.size();
+    for (int s = 0; s < numSprings; s++)
+    {
+        int i0 = 3 * m_spring0[s];
+        int i1 = 3 * m_spring1[s];
+        double d[3] = { m_x[i1 + 0] - m_x[i0 + 0], m_x[i1 + 1] - m_x[i0 + 1], m_x[i1 + 2] - m_x[i0 + 2] };
+        double length = sqrt(d[0] * d[0] + d[1] * d[1] + d[2] * d[2]);
+        if (length < 1e-9)
+        {
+            m_springDir[3 * s + 0] = m_springDir[3 * s + 1] = m_springDir[3 * s + 2] = 0.0;
+            m_springTransverse[s] = 0.0;
+            continue;
+        }
+
+        // the transverse term is clamped for compressed springs, which keeps
+        // the system positive definite
+        double f = m_springK[s] * (length - m_springRest[s]) / length;
+        m_springTransverse[s] = cMax(0.0, 1.0 - m_springRest[s] / length);
+        for (int k = 0; k < 3; k++)
+        {
+            m_springDir[3 * s + k] = d[k] / length;
+            m_force[i0 + k] += f * d[k];
+            m_force[i1 + k] -= f * d[k];
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+
+void cImplicitClothSolver::multiply(const std::vector<double>& a_in, std::vector<double>& a_out) const
+{
+    int numNodes = (int)m_mass.size();
+    double h2 = m_h * m_h;
+
+    // mass and damping
+    for (int i = 0; i < numNodes; i++)
+    {
+        double m = m_mass[i] * (1.0 + m_h * m_damping);
+        a_out[3 * i + 0] = m * a_in[3 * i + 0];
+        a_out[3 * i + 1] = m * a_in[3 * i + 1];
+        a_out[3 * i + 2] = m * a_in[3 * i + 2];
+    }
+
+    // minus h^2 K, one spring at a time: K_s d = k (s d + (1 - s) n (n . d))
+    int numSprings = (int)m_springRest.size();
+    for (int s = 0; s < numSprings; s++)
+    {
+        int i0 = 3 * m_spring0[s];
+        int i1 = 3 * m_spring1[s];
+        const double* n = &m_springDir[3 * s];
+        double t = m_springTransverse[s];
+        double d[3] = { a_in[i1 + 0] - a_in[i0 + 0], a_in[i1 + 1] - a_in[i0 + 1], a_in[i1 + 2] - a_in[i0 + 2] };
+        double nd = n[0] * d[0] + n[1] * d[1] + n[2] * d[2];
+        double k = h2 * m_springK[s];
+        for (int c = 0; c < 3; c++)
+        {
+            double kd = k * (t * d[c] + (1.0 - t) * n[c] * nd);
+            a_out[i0 + c] -= kd;
+            a_out[i1 + c] += kd;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+
+void cImplicitClothSolver::filter(std::vector<double>& a_vector) const
+{
+    int numNodes = (int)m_pinned.size();
+    for (int i = 0; i < numNodes; i++)
+    {
+        if (m_pinned[i])
+        {
+            a_vector[3 * i + 0] = a_vector[3 * i + 1] = a_vector[3 * i + 2] = 0.0;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+
+void cImplicitClothSolver::step(double a_dt)
+{
+    if (a_dt <= 0.0)
+    {
+        return;
+    }
+
+    const cClothParams& params = m_cloth->m_params;
+    int numNodes = (int)m_mass.size();
+    int n = 3 * numNodes;
+    m_h = a_dt;
+    m_damping = params.velocityDamping;
+
+    computeForces();
+
+    // right hand side h (f + h K v), with h K v = -(A v - (M + h c M) v) / h
+    multiply(m_v, m_q);
+    for (int i = 0; i < numNodes; i++)
+    {
+        double m = m_mass[i] * (1.0 + m_h * m_damping);
+        for (int c = 0; c < 3; c++)
+        {
+            double hKv = (m * m_v[3 * i + c] - m_q[3 * i + c]) / m_h;
+            m_rhs[3 * i + c] = m_h * (m_force[3 * i + c] + hKv);
+        }
+    }
+    filter(m_rhs);
+
+    // Jacobi preconditioner, the diagonal of A
+    for (int i = 0; i < numNodes; i++)
+    {
+        double m = m_mass[i] * (1.0 + m_h * m_damping);
+        m_diag[3 * i + 0] = m_diag[3 * i + 1] = m_diag[3 * i + 2] = m;
+    }
+    int numSprings = (int)m_springRest.size();
+    for (int s = 0; s < numSprings; s++)
+    {
+        const double* dir = &m_springDir[3 * s];
+        double t = m_springTransverse[s];
+        double k = m_h * m_h * m_springK[s];
+        for (int c = 0; c < 3; c++)
+        {
+            double kcc = k * (t + (1.0 - t) * dir[c] * dir[c]);
+            m_diag[3 * m_spring0[s] + c] += kcc;
+            m_diag[3 * m_spring1[s] + c] += kcc;
+        }
+    }
+
+    // preconditioned CG, warm started from the previous velocity change
+    filter(m_dv);
+    multiply(m_dv, m_q);
+    for (int i = 0; i < n; i++)
+    {
+        m_r[i] = m_rhs[i] - m_q[i];
+    }
+    filter(m_r);
+    for (int i = 0; i < n; i++)
+    {
+        m_z[i] = m_r[i] / m_diag[i];
+        m_p[i] = m_z[i];
+    }
+
+    double rz = dot(m_r, m_z);
+    double rhsNorm = cMax(dot(m_rhs, m_rhs), 1e-30);
+    double tolerance = params.cgTolerance * params.cgTolerance * rhsNorm;
+    int iteration = 0;
+    double rr = dot(m_r, m_r);
+    while ((iteration < params.cgMaxIterations) && (rr > tolerance))
+    {
+        multiply(m_p, m_q);
+        filter(m_q);
+        double pq = dot(m_p, m_q);
+        if (pq <= 0.0)
+        {
+            break;
+        }
+
+        double alpha = rz / pq;
+        for (int i = 0; i < n; i++)
+        {
+            m_dv[i] += alpha * m_p[i];
+            m_r[i] -= alpha * m_q[i];
+            m_z[i] = m_r[i] / m_diag[i];
+        }
+
+        double rzNext = dot(m_r, m_z);
+        double beta = rzNext / rz;
+        rz = rzNext;
+        for (int i = 0; i < n; i++)
+        {
+            m_p[i] = m_z[i] + beta * m_p[i];
+        }
+
+        rr = dot(m_r, m_r);
+        iteration++;
+    }
+    m_lastIterations = iteration;
+    m_lastResidual = sqrt(rr / rhsNorm);
+
+    // integrate, pinned nodes do not move
+    for (int i = 0; i < n; i++)
+    {
+        m_v[i] += m_dv[i];
+    }
+    for (int i = 0; i < numNodes; i++)
+    {
+        m_nx[i] = m_x[3 * i + 0] + m_h * m_v[3 * i + 0];
+        m_ny[i] = m_x[3 * i + 1] + m_h * m_v[3 * i + 1];
+        m_nz[i] = m_x[3 * i + 2] + m_h * m_v[3 * i + 2];
+    }
+
+    // collisions, corrected nodes take their velocity from the corrected motion
+    bool corrected = (collide(&m_nx[0], &m_ny[0], &m_nz[0],
+        &m_cloth->m_px[0], &m_cloth->m_py[0], &m_cloth->m_pz[0], m_h) > 0);
+    double invH = 1.0 / m_h;
+    for (int i = 0; i < numNodes; i++)
+    {
+        double pos[3] = { m_nx[i], m_ny[i], m_nz[i] };
+        for (int c = 0; c < 3; c++)
+        {
+            if (corrected)
+            {
+                m_v[3 * i + c] = (pos[c] - m_x[3 * i + c]) * invH;
+            }
+            m_x[3 * i + c] = pos[c];
+        }
+    }
+    m_cloth->m_px.swap(m_nx);
+    m_cloth->m_py.swap(m_ny);
+    m_cloth->m_pz.swap(m_nz);
+}
+
+//------------------------------------------------------------------------------
+
+void cImplicitClothSolver::getVelocities(double* a_vx, double* a_vy, double* a_vz) const
+{
+    int numNodes = m_cloth->getNumNodes();
+    for (int i = 0; i < numNodes; i++)
+    {
+        a_vx[i] = m_v[3 * i + 0];
+        a_vy[i] = m_v[3 * i + 1];
+        a_vz[i] = m_v[3 * i + 2];
+    }
+}
+
+//------------------------------------------------------------------------------
+
+void cImplicitClothSolver::setState(const double* a_x, const double* a_y, const double* a_z,
+    const double* a_vx, const double* a_vy, const double* a_vz, const char* a_pinned)
+{
+    int numNodes = m_cloth->getNumNodes();
+    for (int i = 0; i < numNodes; i++)
+    {
+        m_x[3 * i + 0] = a_x[i];
+        m_x[3 * i + 1] = a_y[i];
+        m_x[3 * i + 2] = a_z[i];
+        m_v[3 * i + 0] = a_vx[i];
+        m_v[3 * i + 1] = a_vy[i];
+        m_v[3 * i + 2] = a_vz[i];
+        m_cloth->m_px[i] = a_x[i];
+        m_cloth->m_py[i] = a_y[i];
+        m_cloth->m_pz[i] = a_z[i];
+        m_pinned[i] = a_pinned[i] ? 1 : 0;
+    }
+
+    // the previous velocity change is no guess for the new state
+    std::fill(m_dv.begin(), m_dv.end(), 0.0);
+}
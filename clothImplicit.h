@@ -0,0 +1,106 @@
+#pragma once
+
+#include "clothSolver.h"
+
+#include <vector>
+
+//------------------------------------------------------------------------------
+// DECLARED TYPES
+//------------------------------------------------------------------------------
+
+// implicit (backward Euler) spring cloth. each step solves
+//
+//     (M + h c M - h^2 K) dv = h (f + h K v)
+//
+// for the velocity change dv, with M the lumped masses, c the velocity
+// damping, K the stiffness Jacobian of the springs and f the forces at the
+// start of the step. the system is solved by a Jacobi preconditioned
+// conjugate gradient that never assembles the matrix: products with K are
+// evaluated spring by spring. the solve starts from the previous dv and is
+// capped at cClothParams::cgMaxIterations, which bounds the cost of a step.
+//
+// springs follow the structural links, with bending springs across two
+// cells. pinned nodes are kept out of the solve by zeroing their components
+// in every CG vector.
+class cImplicitClothSolver : public cClothSolver
+{
+public:
+
+    // constructor, builds the springs of a_cloth and resets its positions
+    // to the rest shape
+    cImplicitClothSolver(cClothModel* a_cloth);
+
+    virtual const char* getName() const { return ("implicit"); }
+    virtual void clearExternalForces();
+    virtual void addExternalForce(int a_node, const chai3d::cVector3d& a_force);
+    virtual void step(double a_dt);
+    virtual void getVelocities(double* a_vx, double* a_vy, double* a_vz) const;
+    virtual void setState(const double* a_x, const double* a_y, const double* a_z,
+        const double* a_vx, const double* a_vy, const double* a_vz, const char* a_pinned);
+
+    // CG iterations of the last step
+    int getLastIterations() const { return (m_lastIterations); }
+
+    // relative residual of the last step
+    double getLastResidual() const { return (m_lastResidual); }
+
+protected:
+
+    // add a spring between two nodes at their rest distance
+    void addSpring(int a_node0, int a_node1, double a_stiffness);
+
+    // forces at the current state, and the spring directions used by the Jacobian
+    void computeForces();
+
+    // a_out = (M + h c M - h^2 K) a_in
+    void multiply(const std::vector<double>& a_in, std::vector<double>& a_out) const;
+
+    // zero the components of pinned nodes
+    void filter(std::vector<double>& a_vector) const;
+
+protected:
+
+    // node state, three interleaved components per node
+    std::vector<double> m_x;
+    std::vector<double> m_v;
+    std::vector<double> m_external;
+    std::vector<double> m_force;
+
+    // node masses [kg]
+    std::vector<double> m_mass;
+
+    // spring nodes, rest lengths [m] and stiffnesses [N/m]
+    std::vector<int> m_spring0;
+    std::vector<int> m_spring1;
+    std::vector<double> m_springRest;
+    std::vector<double> m_springK;
+
+    // spring directions (three components each) and transverse stiffness
+    // factor max(0, 1 - rest / length) at the start of the step
+    std::vector<double> m_springDir;
+    std::vector<double> m_springTransverse;
+
+    // step length and damping of the current step
+    double m_h;
+    double m_damping;
+
+    // end of step positions handed to the collision stages
+    std::vector<double> m_nx;
+    std::vector<double> m_ny;
+    std::vector<double> m_nz;
+
+    // velocity change, kept between steps as the initial guess
+    std::vector<double> m_dv;
+
+    // CG vectors
+    std::vector<double> m_rhs;
+    std::vector<double> m_r;
+    std::vector<double> m_z;
+    std::vector<double> m_p;
+    std::vector<double> m_q;
+    std::vector<double> m_diag;
+
+    // statistics of the last solve
+    int m_lastIterations;
+    double m_lastResidual;
+};
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <GLFW/glfw3.h>
+#include <cstddef>
+#include <vector>
+
+//------------------------------------------------------------------------------
+// DECLARED FUNCTIONS
+//------------------------------------------------------------------------------
+
+// fill in the triangle indices of a grid of a_numX * a_numY cells, with
+// (a_numX + 1) * (a_numY + 1) vertices stored row by row
+template <class T>
+void cBuildGridIndices(int a_numX, int a_numY, std::vector<T>& a_indices)
+{
+    a_indices.resize(a_numX * a_numY * 2 * 3);
+    if (a_indices.empty())
+    {
+        return;
+    }
+
+    T* id = &a_indices[0];
+    for (int i = 0; i < a_numY; i++) {
+        for (int j = 0; j < a_numX; j++) {
+            T i0 = (T)(i * (a_numX + 1) + j);
+            T i1 = i0 + 1;
+            T i2 = (T)(i0 + (a_numX + 1));
+            T i3 = i2 + 1;
+            if ((j + i) % 2) {
+                *id++ = i0; *id++ = i2; *id++ = i1;
+                *id++ = i1; *id++ = i2; *id++ = i3;
+            }
+            else {
+                *id++ = i0; *id++ = i2; *id++ = i3;
+                *id++ = i0; *id++ = i3; *id++ = i1;
+            }
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+// DECLARED TYPES
+//------------------------------------------------------------------------------
+
+// triangle indices of a render mesh, stored as 16 bit indices when every
+// vertex can be addressed with them and as 32 bit indices otherwise
+class cClothIndices
+{
+public:
+
+    // constructor
+    cClothIndices() : m_use32Bit(false) {}
+
+    // build the indices of a grid, the index width follows the vertex count
+    void buildGrid(int a_numX, int a_numY)
+    {
+        size_t numVertices = (size_t)(a_numX + 1) * (size_t)(a_numY + 1);
+        m_use32Bit = (numVertices > 65536);
+        if (m_use32Bit)
+        {
+            m_indices16.clear();
+            cBuildGridIndices(a_numX, a_numY, m_indices32);
+        }
+        else
+        {
+            m_indices32.clear();
+            cBuildGridIndices(a_numX, a_numY, m_indices16);
+        }
+    }
+
+    // true if indices are stored on 32 bits
+    bool is32Bit() const { return m_use32Bit; }
+
+    // number of indices
+    size_t size() const { return m_use32Bit ? m_indices32.size() : m_indices16.size(); }
+
+    // index a_i, whatever the storage
+    unsigned int operator[](size_t a_i) const { return m_use32Bit ? m_indices32[a_i] : m_indices16[a_i]; }
+
+    // OpenGL type of the stored indices
+    GLenum getGLType() const { return m_use32Bit ? GL_UNSIGNED_INT : GL_UNSIGNED_SHORT; }
+
+    // raw index data
+    const void* getData() const
+    {
+        if (size() == 0) { return NULL; }
+        return m_use32Bit ? (const void*)&m_indices32[0] : (const void*)&m_indices16[0];
+    }
+
+    // clear all indices
+    void clear() { m_indices16.clear(); m_indices32.clear(); }
+
+public:
+
+    // 16 bit indices, used if is32Bit() is false
+    std::vector<GLushort> m_indices16;
+
+    // 32 bit indices, used if is32Bit() is true
+    std::vector<GLuint> m_indices32;
+
+protected:
+
+    // storage in use
+    bool m_use32Bit;
+};
@@ -0,0 +1,119 @@
+//------------------------------------------------------------------------------
+#include "clothMesh.h"
+//------------------------------------------------------------------------------
+using namespace chai3d;
+//------------------------------------------------------------------------------
+
+cClothRenderMesh::cClothRenderMesh()
+{
+    m_mesh = NULL;
+}
+
+//------------------------------------------------------------------------------
+
+void cClothRenderMesh::create(cMesh* a_mesh, const std::vector<glm::vec3>& a_X, const cClothIndices& a_indices)
+{
+    m_mesh = a_mesh;
+    m_indices = a_indices;
+    m_normals.resize(a_X.size());
+
+    // create one vertex per grid point
+    for (size_t i = 0; i < a_X.size(); i++)
+    {
+        int vertex = m_mesh->newVertex();
+        m_mesh->m_vertices->setLocalPos(vertex, a_X[i].x, a_X[i].y, a_X[i].z);
+
+        // define a vertex color
+        cColorf color;
+        color.set((a_X[i].x + 1) * 0.5, (a_X[i].z + 1) * 0.5, 0.5);
+        m_mesh->m_vertices->setColor(vertex, color);
+    }
+
+    // create triangles on shared vertices
+    for (size_t i = 0; i < m_indices.size(); i += 3)
+    {
+        m_mesh->newTriangle(m_indices[i + 0], m_indices[i + 1], m_indices[i + 2]);
+    }
+
+    updateNormals(a_X);
+}
+
+//------------------------------------------------------------------------------
+
+void cClothRenderMesh::update(const std::vector<glm::vec3>& a_X)
+{
+    // bulk copy of positions
+    std::vector<cVector3d>& localPos = m_mesh->m_vertices->m_localPos;
+    size_t numVertices = a_X.size();
+    for (size_t i = 0; i < numVertices; i++)
+    {
+        localPos[i].set(a_X[i].x, a_X[i].y, a_X[i].z);
+    }
+
+    updateNormals(a_X);
+}
+
+//------------------------------------------------------------------------------
+
+void cClothRenderMesh::updateNormals(const std::vector<glm::vec3>& a_X)
+{
+    size_t numVertices = a_X.size();
+    for (size_t i = 0; i < numVertices; i++)
+    {
+        m_normals[i] = glm::vec3(0.0f, 0.0f, 0.0f);
+    }
+
+    // accumulate face normals with the index width of the mesh
+    if (m_indices.is32Bit())
+    {
+        accumulateNormals(a_X, m_indices.m_indices32);
+    }
+    else
+    {
+        accumulateNormals(a_X, m_indices.m_indices16);
+    }
+
+    // normalize and copy into the mesh
+    std::vector<cVector3d>& normal = m_mesh->m_vertices->m_normal;
+    for (size_t i = 0; i < numVertices; i++)
+    {
+        const glm::vec3& n = m_normals[i];
+        float length = sqrtf(n.x * n.x + n.y * n.y + n.z * n.z);
+        if (length > 0.0f)
+        {
+            normal[i].set(n.x / length, n.y / length, n.z / length);
+        }
+    }
+
+    // positions and normals need to be uploaded again
+    m_mesh->m_vertices->m_flagUpdateDeviceBuffer = true;
+}
+
+//------------------------------------------------------------------------------
+
+template <class T>
+void cClothRenderMesh::accumulateNormals(const std::vector<glm::vec3>& a_X, const std::vector<T>& a_indices)
+{
+    // accumulate area weighted face normals on each vertex of the triangle
+    size_t numIndices = a_indices.size();
+    for (size_t i = 0; i < numIndices; i += 3)
+    {
+        const glm::vec3& p0 = a_X[a_indices[i + 0]];
+        const glm::vec3& p1 = a_X[a_indices[i + 1]];
+        const glm::vec3& p2 = a_X[a_indices[i + 2]];
+
+        float ax = p1.x - p0.x, ay = p1.y - p0.y, az = p1.z - p0.z;
+        float bx = p2.x - p0.x, by = p2.y - p0.y, bz = p2.z - p0.z;
+        float nx = ay * bz - az * by;
+        float ny = az * bx - ax * bz;
+        float nz = ax * by - ay * bx;
+
+        for (int k = 0; k < 3; k++)
+        {
+            glm::vec3& n = m_normals[a_indices[i + k]];
+            n.x += nx;
+            n.y += ny;
+            n.z += nz;
+        }
+    }
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "chai3d.h"
+
+#include "clothIndices.h"
+
+#include <GLFW/glfw3.h>
+#include <vector>
+#include <glm/glm.hpp>
+
+//------------------------------------------------------------------------------
+// DECLARED TYPES
+//------------------------------------------------------------------------------
+
+// indexed render mesh of the cloth: one shared vertex per grid point, with
+// positions and normals updated in bulk every frame
+class cClothRenderMesh
+{
+public:
+
+    // constructor
+    cClothRenderMesh();
+
+    // create vertices and triangles of a_mesh from positions and indices
+    void create(chai3d::cMesh* a_mesh, const std::vector<glm::vec3>& a_X, const cClothIndices& a_indices);
+
+    // copy new positions into the mesh and recompute vertex normals
+    void update(const std::vector<glm::vec3>& a_X);
+
+protected:
+
+    // recompute vertex normals from the current positions
+    void updateNormals(const std::vector<glm::vec3>& a_X);
+
+    // accumulate area weighted face normals on the vertices
+    template <class T>
+    void accumulateNormals(const std::vector<glm::vec3>& a_X, const std::vector<T>& a_indices);
+
+protected:
+
+    // target mesh
+    chai3d::cMesh* m_mesh;
+
+    // triangle indices
+    cClothIndices m_indices;
+
+    // accumulated vertex normals
+    std::vector<glm::vec3> m_normals;
+};
@@ -0,0 +1,155 @@
+//------------------------------------------------------------------------------
+#include "clothMeshCollision.h"
+//------------------------------------------------------------------------------
+#include <algorithm>
+#include <cmath>
+//------------------------------------------------------------------------------
+using namespace chai3d;
+//------------------------------------------------------------------------------
+
+cMeshCollider::cMeshCollider()
+{
+    m_margin = 0.0;
+    m_pass = 0;
+    m_numContacts = 0;
+    m_numSampled = 0;
+    m_maxPenetration = 0.0;
+}
+
+//------------------------------------------------------------------------------
+
+void cMeshCollider::setup(const cClothIndices& a_indices, double a_margin)
+{
+    m_indices = a_indices;
+    m_margin = a_margin;
+    m_bvh = cClothBVH();
+}
+
+//------------------------------------------------------------------------------
+
+bool cMeshCollider::addObstacle(cMesh* a_mesh, double a_cellSize)
+{
+    // the grid reaches past the margin by two cells, so nodes about to touch
+    // the obstacle always sample a meaningful gradient
+    cObstacle obstacle;
+    obstacle.m_mesh = a_mesh;
+    if (!obstacle.m_field.build(a_mesh, a_cellSize, m_margin + 2.0 * a_cellSize))
+    {
+        return (false);
+    }
+    obstacle.m_staticFriction = a_mesh->m_material->getStaticFriction();
+    obstacle.m_dynamicFriction = a_mesh->m_material->getDynamicFriction();
+    m_obstacles.push_back(obstacle);
+    return (true);
+}
+
+//------------------------------------------------------------------------------
+
+int cMeshCollider::collide(const cClothCollisionState& a_state)
+{
+    m_numContacts = 0;
+    m_numSampled = 0;
+    m_maxPenetration = 0.0;
+    if (m_obstacles.empty())
+    {
+        return (0);
+    }
+
+    // the cloth topology is fixed, the tree only follows the nodes
+    if (m_bvh.getNumTriangles() == 0)
+    {
+        m_bvh.build(m_indices, a_state.m_x, a_state.m_y, a_state.m_z);
+    }
+    else
+    {
+        m_bvh.refit(a_state.m_x, a_state.m_y, a_state.m_z);
+    }
+    if ((int)m_visited.size() != a_state.m_numNodes)
+    {
+        m_visited.assign(a_state.m_numNodes, 0);
+        m_pass = 0;
+    }
+
+    for (size_t o = 0; o < m_obstacles.size(); o++)
+    {
+        const cObstacle& obstacle = m_obstacles[o];
+        cVector3d origin = obstacle.m_mesh->getLocalPos();
+        cMatrix3d rot = obstacle.m_mesh->getLocalRot();
+        cMatrix3d rotT = rot.getTranspose();
+
+        // world box of the grid
+        cVector3d gridMin = obstacle.m_field.getBoundaryMin();
+        cVector3d gridMax = obstacle.m_field.getBoundaryMax();
+        cVector3d lower(1e30, 1e30, 1e30);
+        cVector3d upper(-1e30, -1e30, -1e30);
+        for (int c = 0; c < 8; c++)
+        {
+            cVector3d corner((c & 1) ? gridMax(0) : gridMin(0),
+                             (c & 2) ? gridMax(1) : gridMin(1),
+                             (c & 4) ? gridMax(2) : gridMin(2));
+            cVector3d pos = origin + rot * corner;
+            for (int k = 0; k < 3; k++)
+            {
+                lower(k) = std::min(lower(k), pos(k));
+                upper(k) = std::max(upper(k), pos(k));
+            }
+        }
+        if (m_bvh.query(lower, upper, m_candidates) == 0)
+        {
+            continue;
+        }
+
+        m_pass++;
+        for (size_t t = 0; t < m_candidates.size(); t++)
+        {
+            const int* tri = m_bvh.getTriangle(m_candidates[t]);
+            for (int j = 0; j < 3; j++)
+            {
+                int i = tri[j];
+                if ((m_visited[i] == m_pass) || a_state.m_pinned[i])
+                {
+                    continue;
+                }
+                m_visited[i] = m_pass;
+                m_numSampled++;
+
+                // distance in the frame of the mesh
+                cVector3d pos(a_state.m_x[i], a_state.m_y[i], a_state.m_z[i]);
+                cVector3d gradient;
+                double distance = obstacle.m_field.sample(rotT * (pos - origin), gradient, m_margin);
+                double penetration = m_margin - distance;
+                double length = gradient.length();
+                if ((penetration <= 0.0) || (length < 1e-12))
+                {
+                    continue;
+                }
+                cVector3d normal = rot * (gradient / length);
+
+                // push out along the normal
+                pos += penetration * normal;
+
+                // friction against the tangential motion during the step
+                cVector3d motion = pos - cVector3d(a_state.m_x0[i], a_state.m_y0[i], a_state.m_z0[i]);
+                cVector3d tangent = motion - cDot(motion, normal) * normal;
+                double slide = tangent.length();
+                if (slide <= obstacle.m_staticFriction * penetration)
+                {
+                    pos -= tangent;
+                }
+                else
+                {
+                    pos -= std::min(1.0, obstacle.m_dynamicFriction * penetration / slide) * tangent;
+                }
+
+                a_state.m_x[i] = pos(0);
+                a_state.m_y[i] = pos(1);
+                a_state.m_z[i] = pos(2);
+
+                m_numContacts++;
+                m_maxPenetration = std::max(m_maxPenetration, penetration);
+            }
+        }
+    }
+
+    return (m_numContacts);
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "clothBVH.h"
+#include "clothCollision.h"
+#include "distanceField.h"
+
+#include <vector>
+
+//------------------------------------------------------------------------------
+// DECLARED TYPES
+//------------------------------------------------------------------------------
+
+// collision stage of the cloth against arbitrary meshes. the distance to each
+// obstacle is sampled once on a grid in the local frame of the mesh, so an
+// obstacle may still be moved rigidly. every step the cloth BVH is refitted
+// and only the nodes of the leaves overlapping an obstacle grid are sampled,
+// which keeps the cost about linear in the number of nodes near obstacles.
+// nodes closer than the margin are pushed out along the distance gradient,
+// and their tangential motion is reduced by Coulomb friction as on the table.
+//
+// obstacles are placed by their local position and rotation, they must be
+// children of the world.
+class cMeshCollider : public cClothCollider
+{
+public:
+
+    // constructor
+    cMeshCollider();
+
+    // take the triangles of a_indices, nodes are kept a_margin away from the
+    // obstacles. the cloth BVH is built at the first step.
+    void setup(const cClothIndices& a_indices, double a_margin);
+
+    // add a_mesh as an obstacle, with its distance sampled on cells of
+    // a_cellSize. returns false if the mesh has no triangle
+    bool addObstacle(chai3d::cMesh* a_mesh, double a_cellSize);
+
+    // resolve contacts
+    virtual int collide(const cClothCollisionState& a_state);
+
+    // number of obstacles
+    int getNumObstacles() const { return ((int)m_obstacles.size()); }
+
+    // number of nodes in contact at the last collide()
+    int getNumContacts() const { return (m_numContacts); }
+
+    // penetration of the deepest node at the last collide() [m]
+    double getMaxPenetration() const { return (m_maxPenetration); }
+
+    // number of nodes sampled at the last collide()
+    int getNumSampled() const { return (m_numSampled); }
+
+public:
+
+    // distance kept between the nodes and the obstacles [m]
+    double m_margin;
+
+protected:
+
+    // mesh, its distance grid and friction coefficients
+    struct cObstacle
+    {
+        chai3d::cMesh* m_mesh;
+        cDistanceField m_field;
+        double m_staticFriction;
+        double m_dynamicFriction;
+    };
+
+    // obstacles
+    std::vector<cObstacle> m_obstacles;
+
+    // cloth triangles and their hierarchy
+    cClothIndices m_indices;
+    cClothBVH m_bvh;
+
+    // triangles overlapping the current obstacle
+    std::vector<int> m_candidates;
+
+    // last obstacle pass that visited each node, so shared nodes are sampled once
+    std::vector<unsigned int> m_visited;
+    unsigned int m_pass;
+
+    // statistics of the last collide()
+    int m_numContacts;
+    int m_numSampled;
+    double m_maxPenetration;
+};
@@ -0,0 +1,79 @@
+//------------------------------------------------------------------------------
+#include "clothPicking.h"
+//------------------------------------------------------------------------------
+using namespace chai3d;
+//------------------------------------------------------------------------------
+
+cClothPicker::cClothPicker()
+{
+}
+
+//------------------------------------------------------------------------------
+
+bool cClothPicker::pick(const cClothIndices& a_indices, const std::vector<glm::vec3>& a_X,
+    const cVector3d& a_origin, const cVector3d& a_dir, cClothRayHit& a_hit)
+{
+    int numNodes = (int)a_X.size();
+    m_x.resize(numNodes);
+    m_y.resize(numNodes);
+    m_z.resize(numNodes);
+    for (int i = 0; i < numNodes; i++)
+    {
+        m_x[i] = a_X[i].x;
+        m_y[i] = a_X[i].y;
+        m_z[i] = a_X[i].z;
+    }
+
+    if (m_bvh.getNumTriangles() == 0)
+    {
+        m_bvh.build(a_indices, &m_x[0], &m_y[0], &m_z[0]);
+    }
+    else
+    {
+        m_bvh.refit(&m_x[0], &m_y[0], &m_z[0]);
+    }
+
+    return (m_bvh.raycast(a_origin, a_dir, 1e30, &m_x[0], &m_y[0], &m_z[0], a_hit));
+}
+
+//------------------------------------------------------------------------------
+
+cClothGrab cCreateClothGrab(const cClothIndices& a_indices, const cClothRayHit& a_hit, const cVector3d& a_target)
+{
+    cClothGrab grab;
+    grab.m_active = true;
+    for (int j = 0; j < 3; j++)
+    {
+        grab.m_nodes[j] = (int)a_indices[3 * a_hit.m_triangle + j];
+    }
+    grab.m_weights[0] = 1.0 - a_hit.m_u - a_hit.m_v;
+    grab.m_weights[1] = a_hit.m_u;
+    grab.m_weights[2] = a_hit.m_v;
+    grab.m_target = a_target;
+    return (grab);
+}
+
+//------------------------------------------------------------------------------
+
+void cApplyClothGrab(const cClothGrab& a_grab, const cClothModel* a_cloth, cClothSolver* a_solver, double a_stiffness)
+{
+    if (!a_grab.m_active)
+    {
+        return;
+    }
+
+    // current position of the grabbed point
+    cVector3d point(0.0, 0.0, 0.0);
+    for (int j = 0; j < 3; j++)
+    {
+        int i = a_grab.m_nodes[j];
+        point += a_grab.m_weights[j] * cVector3d(a_cloth->m_px[i], a_cloth->m_py[i], a_cloth->m_pz[i]);
+    }
+
+    // a force at the point is shared by the nodes like the position
+    cVector3d force = a_stiffness * (a_grab.m_target - point);
+    for (int j = 0; j < 3; j++)
+    {
+        a_solver->addExternalForce(a_grab.m_nodes[j], a_grab.m_weights[j] * force);
+    }
+}
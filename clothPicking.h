@@ -0,0 +1,67 @@
+#pragma once
+
+#include "cloth.h"
+#include "clothBVH.h"
+#include "clothSolver.h"
+
+#include <vector>
+
+//------------------------------------------------------------------------------
+// DECLARED TYPES
+//------------------------------------------------------------------------------
+
+// point of the cloth held by the mouse, published by the graphics thread. the
+// point is fixed on a triangle by its barycentric weights and pulled toward
+// the target by a spring.
+struct cClothGrab
+{
+    // true while the mouse holds the cloth
+    bool m_active;
+
+    // nodes of the grabbed triangle and their weights
+    int m_nodes[3];
+    double m_weights[3];
+
+    // position the point is pulled toward [m]
+    chai3d::cVector3d m_target;
+};
+
+//------------------------------------------------------------------------------
+
+// ray picking on the rendered cloth. the tree is built over the render
+// positions at the first pick and refitted at the following ones, so a pick
+// costs a copy of the positions and a traversal, without reading back the
+// depth buffer.
+class cClothPicker
+{
+public:
+
+    // constructor
+    cClothPicker();
+
+    // closest triangle of a_indices hit by the ray from a_origin along a_dir
+    // (unit length) at render positions a_X, returns false on a miss
+    bool pick(const cClothIndices& a_indices, const std::vector<glm::vec3>& a_X,
+        const chai3d::cVector3d& a_origin, const chai3d::cVector3d& a_dir, cClothRayHit& a_hit);
+
+protected:
+
+    // tree over the cloth triangles
+    cClothBVH m_bvh;
+
+    // render positions as x/y/z arrays
+    std::vector<double> m_x;
+    std::vector<double> m_y;
+    std::vector<double> m_z;
+};
+
+//------------------------------------------------------------------------------
+// DECLARED FUNCTIONS
+//------------------------------------------------------------------------------
+
+// grab of the point a_hit of a triangle of a_indices, pulled toward a_target
+cClothGrab cCreateClothGrab(const cClothIndices& a_indices, const cClothRayHit& a_hit, const chai3d::cVector3d& a_target);
+
+// pull the grabbed point of a_cloth toward its target with a spring of
+// stiffness a_stiffness [N/m], spread over the triangle nodes by their weights
+void cApplyClothGrab(const cClothGrab& a_grab, const cClothModel* a_cloth, cClothSolver* a_solver, double a_stiffness);
@@ -0,0 +1,587 @@
+//------------------------------------------------------------------------------
+#include "clothSelfCollision.h"
+//------------------------------------------------------------------------------
+#include <algorithm>
+#include <cmath>
+#include <set>
+#include <utility>
+//------------------------------------------------------------------------------
+using namespace chai3d;
+//------------------------------------------------------------------------------
+
+// barycentric weights (v, w) of b and c for the projection of p onto the
+// plane of triangle a, b, c; the weight of a is 1 - v - w
+static inline void projectBarycentric(double a_ax, double a_ay, double a_az, double a_bx, double a_by, double a_bz,
+    double a_cx, double a_cy, double a_cz, double a_px, double a_py, double a_pz, double& a_v, double& a_w)
+{
+    double e1x = a_bx - a_ax, e1y = a_by - a_ay, e1z = a_bz - a_az;
+    double e2x = a_cx - a_ax, e2y = a_cy - a_ay, e2z = a_cz - a_az;
+    double qx = a_px - a_ax, qy = a_py - a_ay, qz = a_pz - a_az;
+    double d00 = e1x * e1x + e1y * e1y + e1z * e1z;
+    double d01 = e1x * e2x + e1y * e2y + e1z * e2z;
+    double d11 = e2x * e2x + e2y * e2y + e2z * e2z;
+    double d20 = qx * e1x + qy * e1y + qz * e1z;
+    double d21 = qx * e2x + qy * e2y + qz * e2z;
+    double denom = 1.0 / std::max(d00 * d11 - d01 * d01, 1e-24);
+    a_v = (d11 * d20 - d01 * d21) * denom;
+    a_w = (d00 * d21 - d01 * d20) * denom;
+}
+
+//------------------------------------------------------------------------------
+
+cSelfCollider::cSelfCollider()
+{
+    m_thickness = 0.0;
+    m_invCellSize = 1.0;
+    m_mask = 0;
+    m_maxReach = 0.0;
+    m_ptCount = 0;
+    m_eeCount = 0;
+}
+
+//------------------------------------------------------------------------------
+
+const char* cSelfCollider::getPhaseName(int a_phase)
+{
+    static const char* names[C_NUM_SELF_PHASES] =
+    {
+        "self broad phase",
+        "self point-triangle",
+        "self edge-edge",
+        "self resolve"
+    };
+    return (names[a_phase]);
+}
+
+//------------------------------------------------------------------------------
+
+void cSelfCollider::setup(const cClothIndices& a_indices, double a_cellSize, double a_thickness)
+{
+    m_thickness = a_thickness;
+    m_invCellSize = 1.0 / a_cellSize;
+
+    // triangles
+    int numTriangles = (int)(a_indices.size() / 3);
+    m_triangles.resize(3 * numTriangles);
+    for (int i = 0; i < 3 * numTriangles; i++)
+    {
+        m_triangles[i] = (int)a_indices[i];
+    }
+
+    // unique edges
+    std::set<std::pair<int, int> > edges;
+    for (int t = 0; t < numTriangles; t++)
+    {
+        for (int k = 0; k < 3; k++)
+        {
+            int n0 = m_triangles[3 * t + k];
+            int n1 = m_triangles[3 * t + (k + 1) % 3];
+            edges.insert(std::make_pair(std::min(n0, n1), std::max(n0, n1)));
+        }
+    }
+    m_edges.clear();
+    for (std::set<std::pair<int, int> >::const_iterator it = edges.begin(); it != edges.end(); ++it)
+    {
+        m_edges.push_back(it->first);
+        m_edges.push_back(it->second);
+    }
+    int numEdges = (int)(m_edges.size() / 2);
+    m_midX.resize(numEdges);
+    m_midY.resize(numEdges);
+    m_midZ.resize(numEdges);
+    m_radius.resize(numEdges);
+
+    // at least twice as many buckets as edges, which outnumber the nodes
+    int tableSize = 1;
+    while (tableSize < 2 * numEdges)
+    {
+        tableSize <<= 1;
+    }
+    m_mask = tableSize - 1;
+    m_nodeStart.assign(tableSize + 1, 0);
+    m_edgeStart.assign(tableSize + 1, 0);
+}
+
+//------------------------------------------------------------------------------
+
+void cSelfCollider::buildHash(const double* a_x, const double* a_y, const double* a_z, int a_count,
+                              std::vector<int>& a_start, std::vector<int>& a_entries, std::vector<double>& a_sorted)
+{
+    // count, prefix sums, then fill from the bucket starts
+    std::fill(a_start.begin(), a_start.end(), 0);
+    for (int i = 0; i < a_count; i++)
+    {
+        a_start[bucket(cellCoord(a_x[i]), cellCoord(a_y[i]), cellCoord(a_z[i])) + 1]++;
+    }
+    for (size_t b = 1; b < a_start.size(); b++)
+    {
+        a_start[b] += a_start[b - 1];
+    }
+
+    a_entries.resize(a_count);
+    a_sorted.resize(3 * a_count);
+    double* sx = &a_sorted[0];
+    double* sy = sx + a_count;
+    double* sz = sy + a_count;
+    for (int i = 0; i < a_count; i++)
+    {
+        int e = a_start[bucket(cellCoord(a_x[i]), cellCoord(a_y[i]), cellCoord(a_z[i]))]++;
+        a_entries[e] = i;
+        sx[e] = a_x[i];
+        sy[e] = a_y[i];
+        sz[e] = a_z[i];
+    }
+
+    // filling advanced each start to the next bucket's start
+    for (size_t b = a_start.size() - 1; b > 0; b--)
+    {
+        a_start[b] = a_start[b - 1];
+    }
+    a_start[0] = 0;
+}
+
+//------------------------------------------------------------------------------
+
+void cSelfCollider::gatherPointTriangle(const cClothCollisionState& a_state)
+{
+    m_ptNode.clear();
+    m_ptTriangle.clear();
+
+    // nodes are hashed at the middle of their motion, which lies within
+    // m_maxReach of any point of it
+    const double* pos[3] = { a_state.m_x, a_state.m_y, a_state.m_z };
+    const double* pos0[3] = { a_state.m_x0, a_state.m_y0, a_state.m_z0 };
+    int numNodes = a_state.m_numNodes;
+    const double* sx = &m_nodeSorted[0];
+    const double* sy = sx + numNodes;
+    const double* sz = sy + numNodes;
+    int numTriangles = (int)(m_triangles.size() / 3);
+    for (int t = 0; t < numTriangles; t++)
+    {
+        const int* tri = &m_triangles[3 * t];
+
+        // box swept by the triangle over the step, inflated by the thickness
+        double lower[3], upper[3];
+        for (int k = 0; k < 3; k++)
+        {
+            lower[k] = std::min(std::min(pos[k][tri[0]], std::min(pos[k][tri[1]], pos[k][tri[2]])),
+                                std::min(pos0[k][tri[0]], std::min(pos0[k][tri[1]], pos0[k][tri[2]]))) - m_thickness;
+            upper[k] = std::max(std::max(pos[k][tri[0]], std::max(pos[k][tri[1]], pos[k][tri[2]])),
+                                std::max(pos0[k][tri[0]], std::max(pos0[k][tri[1]], pos0[k][tri[2]]))) + m_thickness;
+        }
+
+        // node midpoints of the cells overlapping the box grown by the reach
+        int x0 = cellCoord(lower[0] - m_maxReach), x1 = cellCoord(upper[0] + m_maxReach);
+        int y0 = cellCoord(lower[1] - m_maxReach), y1 = cellCoord(upper[1] + m_maxReach);
+        int z0 = cellCoord(lower[2] - m_maxReach), z1 = cellCoord(upper[2] + m_maxReach);
+        for (int x = x0; x <= x1; x++)
+        {
+            for (int y = y0; y <= y1; y++)
+            {
+                for (int z = z0; z <= z1; z++)
+                {
+                    int bk = bucket(x, y, z);
+                    for (int e = m_nodeStart[bk]; e < m_nodeStart[bk + 1]; e++)
+                    {
+                        double px = sx[e], py = sy[e], pz = sz[e];
+                        if ((px < lower[0] - m_maxReach) || (px > upper[0] + m_maxReach) ||
+                            (py < lower[1] - m_maxReach) || (py > upper[1] + m_maxReach) ||
+                            (pz < lower[2] - m_maxReach) || (pz > upper[2] + m_maxReach))
+                        {
+                            continue;
+                        }
+
+                        // a bucket shared by two cells of the box is seen twice
+                        int i = m_nodeEntries[e];
+                        if ((tri[0] == i) || (tri[1] == i) || (tri[2] == i) ||
+                            (cellCoord(px) != x) || (cellCoord(py) != y) || (cellCoord(pz) != z))
+                        {
+                            continue;
+                        }
+
+                        // box swept by the node against the box of the triangle
+                        bool overlap = true;
+                        for (int k = 0; k < 3; k++)
+                        {
+                            overlap = overlap && (std::max(pos[k][i], pos0[k][i]) >= lower[k]) &&
+                                                 (std::min(pos[k][i], pos0[k][i]) <= upper[k]);
+                        }
+                        if (!overlap)
+                        {
+                            continue;
+                        }
+                        m_ptNode.push_back(i);
+                        m_ptTriangle.push_back(t);
+                    }
+                }
+            }
+        }
+    }
+    m_ptCount = (int)m_ptNode.size();
+}
+
+//------------------------------------------------------------------------------
+
+void cSelfCollider::gatherEdgeEdge()
+{
+    m_eeEdge0.clear();
+    m_eeEdge1.clear();
+
+    // a pair of overlapping spheres is reported by the larger one, so every
+    // edge only looks for smaller spheres, whose centers lie within twice
+    // its radius. a few stretched edges do not widen the other queries
+    int numEdges = (int)(m_edges.size() / 2);
+    const double* sx = &m_edgeSorted[0];
+    const double* sy = sx + numEdges;
+    const double* sz = sy + numEdges;
+    const double* sr = &m_radiusSorted[0];
+    for (int e0 = 0; e0 < numEdges; e0++)
+    {
+        int a = m_edges[2 * e0 + 0];
+        int b = m_edges[2 * e0 + 1];
+        double mx = m_midX[e0], my = m_midY[e0], mz = m_midZ[e0];
+        double r0 = m_radius[e0];
+        double reach = 2.0 * r0;
+
+        int x0 = cellCoord(mx - reach), x1 = cellCoord(mx + reach);
+        int y0 = cellCoord(my - reach), y1 = cellCoord(my + reach);
+        int z0 = cellCoord(mz - reach), z1 = cellCoord(mz + reach);
+        for (int x = x0; x <= x1; x++)
+        {
+            for (int y = y0; y <= y1; y++)
+            {
+                for (int z = z0; z <= z1; z++)
+                {
+                    // smaller overlapping spheres, ties broken by index. most
+                    // candidates fail, so survivors are compacted without branching
+                    int bk = bucket(x, y, z);
+                    int begin = m_edgeStart[bk];
+                    int end = m_edgeStart[bk + 1];
+                    m_candidates.resize(std::max((int)m_candidates.size(), end - begin));
+                    int* candidates = m_candidates.empty() ? NULL : &m_candidates[0];
+                    int count = 0;
+                    for (int e = begin; e < end; e++)
+                    {
+                        double dx = sx[e] - mx, dy = sy[e] - my, dz = sz[e] - mz;
+                        double r = r0 + sr[e];
+                        candidates[count] = e;
+                        count += (int)((dx * dx + dy * dy + dz * dz <= r * r) &
+                                       ((sr[e] < r0) | ((sr[e] == r0) & (m_edgeEntries[e] > e0))));
+                    }
+
+                    for (int k = 0; k < count; k++)
+                    {
+                        // never two edges sharing a node, and a bucket shared
+                        // by two cells of the box is seen twice
+                        int e = candidates[k];
+                        int e1 = m_edgeEntries[e];
+                        int c = m_edges[2 * e1 + 0];
+                        int d = m_edges[2 * e1 + 1];
+                        if ((a == c) || (a == d) || (b == c) || (b == d) ||
+                            (cellCoord(sx[e]) != x) || (cellCoord(sy[e]) != y) || (cellCoord(sz[e]) != z))
+                        {
+                            continue;
+                        }
+                        m_eeEdge0.push_back(e0);
+                        m_eeEdge1.push_back(e1);
+                    }
+                }
+            }
+        }
+    }
+    m_eeCount = (int)m_eeEdge0.size();
+}
+
+//------------------------------------------------------------------------------
+
+void cSelfCollider::testPointTriangle(const cClothCollisionState& a_state)
+{
+    m_ptU.resize(m_ptCount);
+    m_ptV.resize(m_ptCount);
+    m_ptW.resize(m_ptCount);
+    m_ptSide.resize(m_ptCount);
+    m_ptNormal.resize(3 * m_ptCount);
+    m_ptHit.resize(m_ptCount);
+
+    const double* x = a_state.m_x;
+    const double* y = a_state.m_y;
+    const double* z = a_state.m_z;
+    const double* x0 = a_state.m_x0;
+    const double* y0 = a_state.m_y0;
+    const double* z0 = a_state.m_z0;
+    double h = m_thickness;
+
+    // branch-free over the batch, hits are only flagged here
+    for (int k = 0; k < m_ptCount; k++)
+    {
+        int p = m_ptNode[k];
+        const int* tri = &m_triangles[3 * m_ptTriangle[k]];
+        int a = tri[0], b = tri[1], c = tri[2];
+
+        // triangle plane at the end of the step
+        double e1x = x[b] - x[a], e1y = y[b] - y[a], e1z = z[b] - z[a];
+        double e2x = x[c] - x[a], e2y = y[c] - y[a], e2z = z[c] - z[a];
+        double nx = e1y * e2z - e1z * e2y;
+        double ny = e1z * e2x - e1x * e2z;
+        double nz = e1x * e2y - e1y * e2x;
+        double area2 = sqrt(nx * nx + ny * ny + nz * nz);
+        double inv = 1.0 / std::max(area2, 1e-18);
+        nx *= inv; ny *= inv; nz *= inv;
+        double px = x[p] - x[a], py = y[p] - y[a], pz = z[p] - z[a];
+        double d1 = px * nx + py * ny + pz * nz;
+
+        // barycentric coordinates of the projection at the end of the step
+        double v, w;
+        projectBarycentric(x[a], y[a], z[a], x[b], y[b], z[b], x[c], y[c], z[c], x[p], y[p], z[p], v, w);
+        double u = 1.0 - v - w;
+
+        // side at the start of the step
+        double f1x = x0[b] - x0[a], f1y = y0[b] - y0[a], f1z = z0[b] - z0[a];
+        double f2x = x0[c] - x0[a], f2y = y0[c] - y0[a], f2z = z0[c] - z0[a];
+        double mx = f1y * f2z - f1z * f2y;
+        double my = f1z * f2x - f1x * f2z;
+        double mz = f1x * f2y - f1y * f2x;
+        double d0 = (x0[p] - x0[a]) * mx + (y0[p] - y0[a]) * my + (z0[p] - z0[a]) * mz;
+        double side = (d0 > 0.0) ? 1.0 : ((d0 < 0.0) ? -1.0 : ((d1 >= 0.0) ? 1.0 : -1.0));
+
+        // a node that ends on the other side crossed the plane when its
+        // distance, linear over the step, was zero. the crossing counts if
+        // it lies inside the triangle at that time.
+        double dist0 = d0 / std::max(sqrt(mx * mx + my * my + mz * mz), 1e-18);
+        bool crossed = (side * d1 < 0.0);
+        double span = dist0 - d1;
+        double s = std::min(1.0, std::max(0.0, dist0 / ((fabs(span) > 1e-18) ? span : 1.0)));
+        double cv, cw;
+        projectBarycentric(x0[a] + s * (x[a] - x0[a]), y0[a] + s * (y[a] - y0[a]), z0[a] + s * (z[a] - z0[a]),
+                           x0[b] + s * (x[b] - x0[b]), y0[b] + s * (y[b] - y0[b]), z0[b] + s * (z[b] - z0[b]),
+                           x0[c] + s * (x[c] - x0[c]), y0[c] + s * (y[c] - y0[c]), z0[c] + s * (z[c] - z0[c]),
+                           x0[p] + s * (x[p] - x0[p]), y0[p] + s * (y[p] - y0[p]), z0[p] + s * (z[p] - z0[p]), cv, cw);
+        double cu = 1.0 - cv - cw;
+
+        // hits within the thickness at the end of the step, or crossings,
+        // which are pushed apart with the weights of the crossing point
+        bool inside = (u >= 0.0) & (v >= 0.0) & (w >= 0.0);
+        bool crossing = crossed & (cu >= 0.0) & (cv >= 0.0) & (cw >= 0.0);
+        m_ptU[k] = inside ? u : cu;
+        m_ptV[k] = inside ? v : cv;
+        m_ptW[k] = inside ? w : cw;
+        m_ptSide[k] = side;
+        m_ptNormal[3 * k + 0] = nx;
+        m_ptNormal[3 * k + 1] = ny;
+        m_ptNormal[3 * k + 2] = nz;
+        m_ptHit[k] = (char)((area2 > 1e-18) & ((inside & (side * d1 < h)) | crossing));
+    }
+}
+
+//------------------------------------------------------------------------------
+
+void cSelfCollider::testEdgeEdge(const cClothCollisionState& a_state)
+{
+    m_eeS.resize(m_eeCount);
+    m_eeT.resize(m_eeCount);
+    m_eeHit.resize(m_eeCount);
+
+    const double* x = a_state.m_x;
+    const double* y = a_state.m_y;
+    const double* z = a_state.m_z;
+    double h2 = m_thickness * m_thickness;
+
+    // closest points of two segments, with the parameter of the second one
+    // clamped first and the first one recomputed from it
+    for (int k = 0; k < m_eeCount; k++)
+    {
+        int a = m_edges[2 * m_eeEdge0[k] + 0], b = m_edges[2 * m_eeEdge0[k] + 1];
+        int c = m_edges[2 * m_eeEdge1[k] + 0], d = m_edges[2 * m_eeEdge1[k] + 1];
+
+        double d1x = x[b] - x[a], d1y = y[b] - y[a], d1z = z[b] - z[a];
+        double d2x = x[d] - x[c], d2y = y[d] - y[c], d2z = z[d] - z[c];
+        double rx = x[a] - x[c], ry = y[a] - y[c], rz = z[a] - z[c];
+        double aa = std::max(d1x * d1x + d1y * d1y + d1z * d1z, 1e-24);
+        double ee = std::max(d2x * d2x + d2y * d2y + d2z * d2z, 1e-24);
+        double bb = d1x * d2x + d1y * d2y + d1z * d2z;
+        double cc = d1x * rx + d1y * ry + d1z * rz;
+        double ff = d2x * rx + d2y * ry + d2z * rz;
+        double denom = aa * ee - bb * bb;
+
+        double s = std::min(1.0, std::max(0.0, (bb * ff - cc * ee) / std::max(denom, 1e-24)));
+        double t = std::min(1.0, std::max(0.0, (bb * s + ff) / ee));
+        s = std::min(1.0, std::max(0.0, (bb * t - cc) / aa));
+
+        double dx = rx + s * d1x - t * d2x;
+        double dy = ry + s * d1y - t * d2y;
+        double dz = rz + s * d1z - t * d2z;
+
+        m_eeS[k] = s;
+        m_eeT[k] = t;
+        m_eeHit[k] = (char)((dx * dx + dy * dy + dz * dz) < h2);
+    }
+}
+
+//------------------------------------------------------------------------------
+
+int cSelfCollider::resolve(const cClothCollisionState& a_state)
+{
+    double* x = a_state.m_x;
+    double* y = a_state.m_y;
+    double* z = a_state.m_z;
+    const char* pinned = a_state.m_pinned;
+    double h = m_thickness;
+    int numResolved = 0;
+
+    // node-triangle: bring the node back to its side, at the thickness
+    for (int k = 0; k < m_ptCount; k++)
+    {
+        if (!m_ptHit[k])
+        {
+            continue;
+        }
+
+        int p = m_ptNode[k];
+        const int* tri = &m_triangles[3 * m_ptTriangle[k]];
+        double bary[3] = { m_ptU[k], m_ptV[k], m_ptW[k] };
+        const double* n = &m_ptNormal[3 * k];
+
+        // distance with the positions moved by the previous corrections
+        double qx = 0.0, qy = 0.0, qz = 0.0;
+        double weight = pinned[p] ? 0.0 : 1.0;
+        for (int j = 0; j < 3; j++)
+        {
+            qx += bary[j] * x[tri[j]];
+            qy += bary[j] * y[tri[j]];
+            qz += bary[j] * z[tri[j]];
+            weight += pinned[tri[j]] ? 0.0 : bary[j] * bary[j];
+        }
+        double distance = m_ptSide[k] * ((x[p] - qx) * n[0] + (y[p] - qy) * n[1] + (z[p] - qz) * n[2]);
+        if ((distance >= h) || (weight <= 0.0))
+        {
+            continue;
+        }
+
+        double s = m_ptSide[k] * (h - distance) / weight;
+        if (!pinned[p])
+        {
+            x[p] += s * n[0];
+            y[p] += s * n[1];
+            z[p] += s * n[2];
+        }
+        for (int j = 0; j < 3; j++)
+        {
+            int v = tri[j];
+            if (!pinned[v])
+            {
+                x[v] -= s * bary[j] * n[0];
+                y[v] -= s * bary[j] * n[1];
+                z[v] -= s * bary[j] * n[2];
+            }
+        }
+        numResolved++;
+    }
+
+    // edge-edge: separate the closest points along their offset
+    for (int k = 0; k < m_eeCount; k++)
+    {
+        if (!m_eeHit[k])
+        {
+            continue;
+        }
+
+        int nodes[4] = { m_edges[2 * m_eeEdge0[k] + 0], m_edges[2 * m_eeEdge0[k] + 1],
+                         m_edges[2 * m_eeEdge1[k] + 0], m_edges[2 * m_eeEdge1[k] + 1] };
+        double s = m_eeS[k];
+        double t = m_eeT[k];
+        double bary[4] = { 1.0 - s, s, -(1.0 - t), -t };
+
+        double dx = 0.0, dy = 0.0, dz = 0.0, weight = 0.0;
+        for (int j = 0; j < 4; j++)
+        {
+            dx += bary[j] * x[nodes[j]];
+            dy += bary[j] * y[nodes[j]];
+            dz += bary[j] * z[nodes[j]];
+            weight += pinned[nodes[j]] ? 0.0 : bary[j] * bary[j];
+        }
+        double distance = sqrt(dx * dx + dy * dy + dz * dz);
+        if ((distance >= h) || (distance < 1e-12) || (weight <= 0.0))
+        {
+            continue;
+        }
+
+        double scale = (h - distance) / (distance * weight);
+        for (int j = 0; j < 4; j++)
+        {
+            int v = nodes[j];
+            if (!pinned[v])
+            {
+                x[v] += scale * bary[j] * dx;
+                y[v] += scale * bary[j] * dy;
+                z[v] += scale * bary[j] * dz;
+            }
+        }
+        numResolved++;
+    }
+
+    return (numResolved);
+}
+
+//------------------------------------------------------------------------------
+
+int cSelfCollider::collide(const cClothCollisionState& a_state)
+{
+    unsigned long long t0 = cTimestampNs();
+
+    // edge spheres at the end of the step
+    int numEdges = (int)(m_edges.size() / 2);
+    for (int e = 0; e < numEdges; e++)
+    {
+        int a = m_edges[2 * e + 0];
+        int b = m_edges[2 * e + 1];
+        double dx = a_state.m_x[b] - a_state.m_x[a];
+        double dy = a_state.m_y[b] - a_state.m_y[a];
+        double dz = a_state.m_z[b] - a_state.m_z[a];
+        m_midX[e] = 0.5 * (a_state.m_x[a] + a_state.m_x[b]);
+        m_midY[e] = 0.5 * (a_state.m_y[a] + a_state.m_y[b]);
+        m_midZ[e] = 0.5 * (a_state.m_z[a] + a_state.m_z[b]);
+        m_radius[e] = 0.5 * sqrt(dx * dx + dy * dy + dz * dz) + 0.5 * m_thickness;
+    }
+
+    // middle of the motion of each node, and the longest half motion
+    int numNodes = a_state.m_numNodes;
+    m_sweepX.resize(numNodes);
+    m_sweepY.resize(numNodes);
+    m_sweepZ.resize(numNodes);
+    double reach2 = 0.0;
+    for (int i = 0; i < numNodes; i++)
+    {
+        double dx = a_state.m_x[i] - a_state.m_x0[i];
+        double dy = a_state.m_y[i] - a_state.m_y0[i];
+        double dz = a_state.m_z[i] - a_state.m_z0[i];
+        m_sweepX[i] = a_state.m_x0[i] + 0.5 * dx;
+        m_sweepY[i] = a_state.m_y0[i] + 0.5 * dy;
+        m_sweepZ[i] = a_state.m_z0[i] + 0.5 * dz;
+        reach2 = std::max(reach2, dx * dx + dy * dy + dz * dz);
+    }
+    m_maxReach = 0.5 * sqrt(reach2);
+
+    buildHash(&m_sweepX[0], &m_sweepY[0], &m_sweepZ[0], numNodes, m_nodeStart, m_nodeEntries, m_nodeSorted);
+    buildHash(&m_midX[0], &m_midY[0], &m_midZ[0], numEdges, m_edgeStart, m_edgeEntries, m_edgeSorted);
+    m_radiusSorted.resize(numEdges);
+    for (int e = 0; e < numEdges; e++)
+    {
+        m_radiusSorted[e] = m_radius[m_edgeEntries[e]];
+    }
+    gatherPointTriangle(a_state);
+    gatherEdgeEdge();
+    unsigned long long t1 = cTimestampNs();
+    testPointTriangle(a_state);
+    unsigned long long t2 = cTimestampNs();
+    testEdgeEdge(a_state);
+    unsigned long long t3 = cTimestampNs();
+    int numResolved = resolve(a_state);
+    unsigned long long t4 = cTimestampNs();
+
+    m_histograms[C_SELF_BROAD_PHASE].record(t1 - t0);
+    m_histograms[C_SELF_POINT_TRIANGLE].record(t2 - t1);
+    m_histograms[C_SELF_EDGE_EDGE].record(t3 - t2);
+    m_histograms[C_SELF_RESOLVE].record(t4 - t3);
+
+    return (numResolved);
+}
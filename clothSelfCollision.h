@@ -0,0 +1,162 @@
+#pragma once
+
+#include "clothCollision.h"
+#include "clothIndices.h"
+#include "latencyHistogram.h"
+
+#include <vector>
+
+//------------------------------------------------------------------------------
+// DECLARED TYPES
+//------------------------------------------------------------------------------
+
+// phases of a self-collision pass
+enum cSelfCollisionPhase
+{
+    C_SELF_BROAD_PHASE = 0,
+    C_SELF_POINT_TRIANGLE,
+    C_SELF_EDGE_EDGE,
+    C_SELF_RESOLVE,
+    C_NUM_SELF_PHASES
+};
+
+//------------------------------------------------------------------------------
+
+// self-collision of the cloth. the broad phase hashes the middle of the
+// motion of each node and the edge midpoints into a uniform grid, each by a
+// counting sort into flat arrays rebuilt every step. triangles query the node
+// grid over the boxes they sweep during the step, edges query the midpoint
+// grid over their bounding spheres. candidate node-triangle and edge-edge
+// pairs are gathered into contiguous batches and tested by branch-free loops,
+// then the hits are pushed apart to the cloth thickness.
+//
+// node-triangle tests are continuous: a node that crossed a triangle during
+// the step, with node and triangle moving linearly, is returned to the side
+// it came from however far it went. edge-edge tests only keep edges at the
+// thickness at the end of the step.
+class cSelfCollider : public cClothCollider
+{
+public:
+
+    // constructor
+    cSelfCollider();
+
+    // take the triangles of a_indices, with cells of a_cellSize and a minimum
+    // distance of a_thickness between the layers
+    void setup(const cClothIndices& a_indices, double a_cellSize, double a_thickness);
+
+    // resolve contacts
+    virtual int collide(const cClothCollisionState& a_state);
+
+    // number of node-triangle and edge-edge pairs tested at the last collide()
+    int getNumPointTrianglePairs() const { return (m_ptCount); }
+    int getNumEdgeEdgePairs() const { return (m_eeCount); }
+
+    // duration of each phase
+    const cLatencyHistogram& getHistogram(int a_phase) const { return (m_histograms[a_phase]); }
+
+    // display name of a phase
+    static const char* getPhaseName(int a_phase);
+
+public:
+
+    // minimum distance between layers [m]
+    double m_thickness;
+
+protected:
+
+    // counting sort of a_count points into the cells of a grid: the points of
+    // bucket b are a_entries[a_start[b] .. a_start[b + 1]], and a_sorted holds
+    // their coordinates in the same order (three arrays of a_count)
+    void buildHash(const double* a_x, const double* a_y, const double* a_z, int a_count,
+                   std::vector<int>& a_start, std::vector<int>& a_entries, std::vector<double>& a_sorted);
+
+    // cell coordinate of a scalar position, a truncation corrected for
+    // negative values is much cheaper than floor()
+    int cellCoord(double a_value) const
+    {
+        double s = a_value * m_invCellSize;
+        int i = (int)s;
+        return (i - (s < (double)i));
+    }
+
+    // bucket of a cell
+    int bucket(int a_x, int a_y, int a_z) const
+    {
+        unsigned int h = ((unsigned int)a_x * 73856093u) ^ ((unsigned int)a_y * 19349663u) ^ ((unsigned int)a_z * 83492791u);
+        h = (h ^ (h >> 16)) * 0x45d9f3bu;
+        return (int)(h ^ (h >> 16)) & m_mask;
+    }
+
+    // gather candidate pairs
+    void gatherPointTriangle(const cClothCollisionState& a_state);
+    void gatherEdgeEdge();
+
+    // narrow phase over the gathered pairs
+    void testPointTriangle(const cClothCollisionState& a_state);
+    void testEdgeEdge(const cClothCollisionState& a_state);
+
+    // push hits apart, returns the number of corrected pairs
+    int resolve(const cClothCollisionState& a_state);
+
+protected:
+
+    // triangle nodes, three per triangle
+    std::vector<int> m_triangles;
+
+    // unique edges, two nodes each
+    std::vector<int> m_edges;
+
+    // grid cells and buckets
+    double m_invCellSize;
+    int m_mask;
+
+    // middle of the motion of each node over the step, and the longest half
+    // motion, by which the triangle queries are grown
+    std::vector<double> m_sweepX;
+    std::vector<double> m_sweepY;
+    std::vector<double> m_sweepZ;
+    double m_maxReach;
+
+    // node grid
+    std::vector<int> m_nodeStart;
+    std::vector<int> m_nodeEntries;
+    std::vector<double> m_nodeSorted;
+
+    // edge midpoints, bounding sphere radii (half the length plus half the
+    // thickness, so overlapping spheres bound the candidate pairs)
+    // and their grid
+    std::vector<double> m_midX;
+    std::vector<double> m_midY;
+    std::vector<double> m_midZ;
+    std::vector<double> m_radius;
+    std::vector<int> m_edgeStart;
+    std::vector<int> m_edgeEntries;
+    std::vector<double> m_edgeSorted;
+    std::vector<double> m_radiusSorted;
+
+    // bucket entries surviving the sphere test of one query
+    std::vector<int> m_candidates;
+
+    // node-triangle pairs: node, triangle, then test results
+    int m_ptCount;
+    std::vector<int> m_ptNode;
+    std::vector<int> m_ptTriangle;
+    std::vector<double> m_ptU;
+    std::vector<double> m_ptV;
+    std::vector<double> m_ptW;
+    std::vector<double> m_ptSide;
+    std::vector<double> m_ptNormal;
+    std::vector<char> m_ptHit;
+
+    // edge-edge pairs: edges, then test results
+    int m_eeCount;
+    std::vector<int> m_eeEdge0;
+    std::vector<int> m_eeEdge1;
+    std::vector<double> m_eeS;
+    std::vector<double> m_eeT;
+    std::vector<char> m_eeHit;
+
+    // phase timings
+    cLatencyHistogram m_histograms[C_NUM_SELF_PHASES];
+};
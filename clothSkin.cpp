@@ -0,0 +1,365 @@
+//------------------------------------------------------------------------------
+#include "clothSkin.h"
+//------------------------------------------------------------------------------
+#include <algorithm>
+#include <cmath>
+#if defined(C_SKIN_USE_AVX)
+#include <immintrin.h>
+#elif defined(C_SKIN_USE_SSE2)
+#include <emmintrin.h>
+#endif
+//------------------------------------------------------------------------------
+using namespace chai3d;
+//------------------------------------------------------------------------------
+
+// smallest chunks of node rows and skin rows handed to a thread
+static const int C_NODE_ROW_GRAIN = 4;
+static const int C_SKIN_ROW_GRAIN = 8;
+
+// squared normal length below which a normal is left unnormalized
+static const float C_SKIN_MIN_NORMAL = 1e-30f;
+
+//------------------------------------------------------------------------------
+
+// blend four node rows into a_count skin vertices with weights a_w. the
+// position rows a_pos blended with the derivative weights a_d give the
+// derivative along z, the derivative rows a_du blended with a_w give the one
+// along x, and their cross product the normal.
+static void blendRow(const float* const a_pos[4][3], const float* const a_du[4][3],
+    const float* a_w, const float* a_d, int a_count,
+    float* const a_outPos[3], float* const a_outNormal[3])
+{
+    int i = 0;
+
+#if defined(C_SKIN_USE_AVX)
+
+    __m256 w[4], d[4];
+    for (int k = 0; k < 4; k++)
+    {
+        w[k] = _mm256_set1_ps(a_w[k]);
+        d[k] = _mm256_set1_ps(a_d[k]);
+    }
+    const __m256 minNormal = _mm256_set1_ps(C_SKIN_MIN_NORMAL);
+    const __m256 one = _mm256_set1_ps(1.0f);
+
+    for (; i + 8 <= a_count; i += 8)
+    {
+        __m256 p[3], u[3], v[3];
+        for (int c = 0; c < 3; c++)
+        {
+            p[c] = _mm256_setzero_ps();
+            u[c] = _mm256_setzero_ps();
+            v[c] = _mm256_setzero_ps();
+        }
+        for (int k = 0; k < 4; k++)
+        {
+            for (int c = 0; c < 3; c++)
+            {
+                __m256 x = _mm256_loadu_ps(a_pos[k][c] + i);
+                p[c] = _mm256_add_ps(p[c], _mm256_mul_ps(w[k], x));
+                v[c] = _mm256_add_ps(v[c], _mm256_mul_ps(d[k], x));
+                u[c] = _mm256_add_ps(u[c], _mm256_mul_ps(w[k], _mm256_loadu_ps(a_du[k][c] + i)));
+            }
+        }
+
+        __m256 nx = _mm256_sub_ps(_mm256_mul_ps(v[1], u[2]), _mm256_mul_ps(v[2], u[1]));
+        __m256 ny = _mm256_sub_ps(_mm256_mul_ps(v[2], u[0]), _mm256_mul_ps(v[0], u[2]));
+        __m256 nz = _mm256_sub_ps(_mm256_mul_ps(v[0], u[1]), _mm256_mul_ps(v[1], u[0]));
+        __m256 n2 = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(nx, nx), _mm256_mul_ps(ny, ny)), _mm256_mul_ps(nz, nz));
+        __m256 s = _mm256_div_ps(one, _mm256_sqrt_ps(_mm256_max_ps(n2, minNormal)));
+
+        for (int c = 0; c < 3; c++)
+        {
+            _mm256_storeu_ps(a_outPos[c] + i, p[c]);
+        }
+        _mm256_storeu_ps(a_outNormal[0] + i, _mm256_mul_ps(nx, s));
+        _mm256_storeu_ps(a_outNormal[1] + i, _mm256_mul_ps(ny, s));
+        _mm256_storeu_ps(a_outNormal[2] + i, _mm256_mul_ps(nz, s));
+    }
+
+#elif defined(C_SKIN_USE_SSE2)
+
+    __m128 w[4], d[4];
+    for (int k = 0; k < 4; k++)
+    {
+        w[k] = _mm_set1_ps(a_w[k]);
+        d[k] = _mm_set1_ps(a_d[k]);
+    }
+    const __m128 minNormal = _mm_set1_ps(C_SKIN_MIN_NORMAL);
+    const __m128 one = _mm_set1_ps(1.0f);
+
+    for (; i + 4 <= a_count; i += 4)
+    {
+        __m128 p[3], u[3], v[3];
+        for (int c = 0; c < 3; c++)
+        {
+            p[c] = _mm_setzero_ps();
+            u[c] = _mm_setzero_ps();
+            v[c] = _mm_setzero_ps();
+        }
+        for (int k = 0; k < 4; k++)
+        {
+            for (int c = 0; c < 3; c++)
+            {
+                __m128 x = _mm_loadu_ps(a_pos[k][c] + i);
+                p[c] = _mm_add_ps(p[c], _mm_mul_ps(w[k], x));
+                v[c] = _mm_add_ps(v[c], _mm_mul_ps(d[k], x));
+                u[c] = _mm_add_ps(u[c], _mm_mul_ps(w[k], _mm_loadu_ps(a_du[k][c] + i)));
+            }
+        }
+
+        __m128 nx = _mm_sub_ps(_mm_mul_ps(v[1], u[2]), _mm_mul_ps(v[2], u[1]));
+        __m128 ny = _mm_sub_ps(_mm_mul_ps(v[2], u[0]), _mm_mul_ps(v[0], u[2]));
+        __m128 nz = _mm_sub_ps(_mm_mul_ps(v[0], u[1]), _mm_mul_ps(v[1], u[0]));
+        __m128 n2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, nx), _mm_mul_ps(ny, ny)), _mm_mul_ps(nz, nz));
+        __m128 s = _mm_div_ps(one, _mm_sqrt_ps(_mm_max_ps(n2, minNormal)));
+
+        for (int c = 0; c < 3; c++)
+        {
+            _mm_storeu_ps(a_outPos[c] + i, p[c]);
+        }
+        _mm_storeu_ps(a_outNormal[0] + i, _mm_mul_ps(nx, s));
+        _mm_storeu_ps(a_outNormal[1] + i, _mm_mul_ps(ny, s));
+        _mm_storeu_ps(a_outNormal[2] + i, _mm_mul_ps(nz, s));
+    }
+
+#endif
+
+    // remaining vertices, or all of them on the scalar path
+    for (; i < a_count; i++)
+    {
+        float p[3] = { 0.0f, 0.0f, 0.0f };
+        float u[3] = { 0.0f, 0.0f, 0.0f };
+        float v[3] = { 0.0f, 0.0f, 0.0f };
+        for (int k = 0; k < 4; k++)
+        {
+            for (int c = 0; c < 3; c++)
+            {
+                float x = a_pos[k][c][i];
+                p[c] += a_w[k] * x;
+                v[c] += a_d[k] * x;
+                u[c] += a_w[k] * a_du[k][c][i];
+            }
+        }
+
+        float nx = v[1] * u[2] - v[2] * u[1];
+        float ny = v[2] * u[0] - v[0] * u[2];
+        float nz = v[0] * u[1] - v[1] * u[0];
+        float s = 1.0f / sqrtf(std::max(nx * nx + ny * ny + nz * nz, C_SKIN_MIN_NORMAL));
+
+        for (int c = 0; c < 3; c++)
+        {
+            a_outPos[c][i] = p[c];
+        }
+        a_outNormal[0][i] = nx * s;
+        a_outNormal[1][i] = ny * s;
+        a_outNormal[2][i] = nz * s;
+    }
+}
+
+//------------------------------------------------------------------------------
+
+cClothSkin::cClothSkin()
+{
+    m_mesh = NULL;
+    m_pool = NULL;
+    m_numNodesX = 0;
+    m_numNodesY = 0;
+    m_numX = 0;
+    m_numY = 0;
+}
+
+//------------------------------------------------------------------------------
+
+void cClothSkin::buildTaps(int a_numNodes, int a_refinement, std::vector<cSkinTaps>& a_taps)
+{
+    int numSamples = (a_numNodes - 1) * a_refinement + 1;
+    a_taps.resize(numSamples);
+
+    for (int s = 0; s < numSamples; s++)
+    {
+        // cell and position inside it, the last sample ends the last cell
+        int cell = std::min(s / a_refinement, a_numNodes - 2);
+        double t = (double)(s - cell * a_refinement) / (double)a_refinement;
+        double t2 = t * t;
+        double t3 = t2 * t;
+
+        // Catmull-Rom weights of nodes cell - 1 .. cell + 2 and their derivatives
+        double w[4] = { 0.5 * (-t3 + 2.0 * t2 - t), 0.5 * (3.0 * t3 - 5.0 * t2 + 2.0),
+                        0.5 * (-3.0 * t3 + 4.0 * t2 + t), 0.5 * (t3 - t2) };
+        double d[4] = { 0.5 * (-3.0 * t2 + 4.0 * t - 1.0), 0.5 * (9.0 * t2 - 10.0 * t),
+                        0.5 * (-9.0 * t2 + 8.0 * t + 1.0), 0.5 * (3.0 * t2 - 2.0 * t) };
+
+        // a ghost node past a border is 2 p0 - p1, so its weight moves to the
+        // two border nodes and every tap lands on one of four real nodes
+        int first = std::max(0, std::min(cell - 1, a_numNodes - 4));
+        double weight[4] = { 0.0, 0.0, 0.0, 0.0 };
+        double derivative[4] = { 0.0, 0.0, 0.0, 0.0 };
+        for (int k = 0; k < 4; k++)
+        {
+            int node = cell - 1 + k;
+            int target[2] = { node, node };
+            double factor[2] = { 1.0, 0.0 };
+            if (node < 0)
+            {
+                target[0] = 0; target[1] = 1;
+                factor[0] = 2.0; factor[1] = -1.0;
+            }
+            else if (node >= a_numNodes)
+            {
+                target[0] = a_numNodes - 1; target[1] = a_numNodes - 2;
+                factor[0] = 2.0; factor[1] = -1.0;
+            }
+            for (int j = 0; j < 2; j++)
+            {
+                weight[target[j] - first] += factor[j] * w[k];
+                derivative[target[j] - first] += factor[j] * d[k];
+            }
+        }
+
+        // grids of less than four nodes leave the last taps unused
+        cSkinTaps& taps = a_taps[s];
+        for (int k = 0; k < 4; k++)
+        {
+            taps.m_node[k] = std::min(first + k, a_numNodes - 1);
+            taps.m_weight[k] = (float)weight[k];
+            taps.m_derivative[k] = (float)derivative[k];
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+
+void cClothSkin::create(cMesh* a_mesh, int a_numNodesX, int a_numNodesY, int a_refinement,
+    const std::vector<glm::vec3>& a_X)
+{
+    m_mesh = a_mesh;
+    m_numNodesX = a_numNodesX;
+    m_numNodesY = a_numNodesY;
+    a_refinement = std::max(1, a_refinement);
+    buildTaps(m_numNodesX, a_refinement, m_tapsX);
+    buildTaps(m_numNodesY, a_refinement, m_tapsY);
+    m_numX = (int)m_tapsX.size();
+    m_numY = (int)m_tapsY.size();
+
+    for (int c = 0; c < 3; c++)
+    {
+        m_rowPos[c].resize(m_numNodesY * m_numX);
+        m_rowDu[c].resize(m_numNodesY * m_numX);
+        m_pos[c].resize(m_numY * m_numX);
+        m_normal[c].resize(m_numY * m_numX);
+    }
+
+    // one vertex per skin sample, triangulated like the cloth grid
+    int numVertices = m_numX * m_numY;
+    for (int i = 0; i < numVertices; i++)
+    {
+        m_mesh->newVertex();
+    }
+    m_indices.buildGrid(m_numX - 1, m_numY - 1);
+    for (size_t i = 0; i < m_indices.size(); i += 3)
+    {
+        m_mesh->newTriangle(m_indices[i + 0], m_indices[i + 1], m_indices[i + 2]);
+    }
+
+    // colors follow the initial shape, like the coarse render mesh
+    update(a_X);
+    for (int i = 0; i < numVertices; i++)
+    {
+        cColorf color;
+        color.set((m_pos[0][i] + 1) * 0.5, (m_pos[2][i] + 1) * 0.5, 0.5);
+        m_mesh->m_vertices->setColor(i, color);
+    }
+}
+
+//------------------------------------------------------------------------------
+
+void cClothSkin::update(const std::vector<glm::vec3>& a_X)
+{
+    if (m_pool != NULL)
+    {
+        m_pool->parallelFor(0, m_numNodesY, C_NODE_ROW_GRAIN, [&](int a_begin, int a_end)
+        {
+            interpolateRows(a_X, a_begin, a_end);
+        });
+        m_pool->parallelFor(0, m_numY, C_SKIN_ROW_GRAIN, [&](int a_begin, int a_end)
+        {
+            evaluateRows(a_begin, a_end);
+        });
+    }
+    else
+    {
+        interpolateRows(a_X, 0, m_numNodesY);
+        evaluateRows(0, m_numY);
+    }
+
+    // positions and normals need to be uploaded again
+    m_mesh->m_vertices->m_flagUpdateDeviceBuffer = true;
+}
+
+//------------------------------------------------------------------------------
+
+void cClothSkin::interpolateRows(const std::vector<glm::vec3>& a_X, int a_begin, int a_end)
+{
+    for (int j = a_begin; j < a_end; j++)
+    {
+        const glm::vec3* row = &a_X[j * m_numNodesX];
+        int offset = j * m_numX;
+        for (int i = 0; i < m_numX; i++)
+        {
+            const cSkinTaps& taps = m_tapsX[i];
+            float p[3] = { 0.0f, 0.0f, 0.0f };
+            float du[3] = { 0.0f, 0.0f, 0.0f };
+            for (int k = 0; k < 4; k++)
+            {
+                const glm::vec3& node = row[taps.m_node[k]];
+                float x[3] = { node.x, node.y, node.z };
+                for (int c = 0; c < 3; c++)
+                {
+                    p[c] += taps.m_weight[k] * x[c];
+                    du[c] += taps.m_derivative[k] * x[c];
+                }
+            }
+            for (int c = 0; c < 3; c++)
+            {
+                m_rowPos[c][offset + i] = p[c];
+                m_rowDu[c][offset + i] = du[c];
+            }
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+
+void cClothSkin::evaluateRows(int a_begin, int a_end)
+{
+    std::vector<cVector3d>& localPos = m_mesh->m_vertices->m_localPos;
+    std::vector<cVector3d>& normal = m_mesh->m_vertices->m_normal;
+
+    for (int r = a_begin; r < a_end; r++)
+    {
+        const cSkinTaps& taps = m_tapsY[r];
+        const float* pos[4][3];
+        const float* du[4][3];
+        for (int k = 0; k < 4; k++)
+        {
+            for (int c = 0; c < 3; c++)
+            {
+                pos[k][c] = &m_rowPos[c][taps.m_node[k] * m_numX];
+                du[k][c] = &m_rowDu[c][taps.m_node[k] * m_numX];
+            }
+        }
+
+        int offset = r * m_numX;
+        float* outPos[3] = { &m_pos[0][offset], &m_pos[1][offset], &m_pos[2][offset] };
+        float* outNormal[3] = { &m_normal[0][offset], &m_normal[1][offset], &m_normal[2][offset] };
+        blendRow(pos, du, taps.m_weight, taps.m_derivative, m_numX, outPos, outNormal);
+
+        // copy the row into the mesh
+        for (int i = 0; i < m_numX; i++)
+        {
+            localPos[offset + i].set(outPos[0][i], outPos[1][i], outPos[2][i]);
+            normal[offset + i].set(outNormal[0][i], outNormal[1][i], outNormal[2][i]);
+        }
+    }
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include "chai3d.h"
+#include "clothIndices.h"
+#include "threadPool.h"
+
+#include <vector>
+#include <glm/glm.hpp>
+
+//------------------------------------------------------------------------------
+// DECLARED MACROS
+//------------------------------------------------------------------------------
+
+// define C_SKIN_USE_SCALAR to disable the SSE2/AVX code paths
+#if !defined(C_SKIN_USE_SCALAR)
+#if defined(__AVX__)
+#define C_SKIN_USE_AVX
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define C_SKIN_USE_SSE2
+#endif
+#endif
+
+//------------------------------------------------------------------------------
+// DECLARED TYPES
+//------------------------------------------------------------------------------
+
+// render mesh several times denser than the cloth grid. the skin is a
+// Catmull-Rom bicubic surface through the cloth nodes, with ghost nodes
+// extrapolated linearly past the borders, evaluated every frame from the
+// node positions. the surface is separable: a first pass interpolates every
+// node row at the skin columns, a second pass blends four of those rows for
+// each skin row, and takes the normal from the two surface derivatives. the
+// second pass does most of the work and runs on contiguous float arrays,
+// several columns at a time, with rows split over a thread pool.
+class cClothSkin
+{
+public:
+
+    // constructor
+    cClothSkin();
+
+    // create the vertices and triangles of a_mesh for a grid of a_numNodesX *
+    // a_numNodesY nodes at positions a_X, with a_refinement skin cells along
+    // each side of a grid cell
+    void create(chai3d::cMesh* a_mesh, int a_numNodesX, int a_numNodesY, int a_refinement,
+        const std::vector<glm::vec3>& a_X);
+
+    // evaluate on a_pool, or on the calling thread if NULL (not owned)
+    void setThreadPool(cThreadPool* a_pool) { m_pool = a_pool; }
+
+    // evaluate the skin positions and normals at node positions a_X
+    void update(const std::vector<glm::vec3>& a_X);
+
+    // number of skin vertices along x and z
+    int getNumVerticesX() const { return (m_numX); }
+    int getNumVerticesY() const { return (m_numY); }
+
+protected:
+
+    // nodes and weights of the cubic at one skin sample along an axis
+    struct cSkinTaps
+    {
+        int m_node[4];
+        float m_weight[4];
+        float m_derivative[4];
+    };
+
+    // taps of the (a_numNodes - 1) * a_refinement + 1 samples along an axis
+    static void buildTaps(int a_numNodes, int a_refinement, std::vector<cSkinTaps>& a_taps);
+
+    // first pass over node rows [a_begin, a_end)
+    void interpolateRows(const std::vector<glm::vec3>& a_X, int a_begin, int a_end);
+
+    // second pass over skin rows [a_begin, a_end), written to the mesh
+    void evaluateRows(int a_begin, int a_end);
+
+protected:
+
+    // target mesh
+    chai3d::cMesh* m_mesh;
+
+    // thread pool, or NULL
+    cThreadPool* m_pool;
+
+    // grid nodes and skin vertices along x and z
+    int m_numNodesX;
+    int m_numNodesY;
+    int m_numX;
+    int m_numY;
+
+    // taps of the skin columns and rows
+    std::vector<cSkinTaps> m_tapsX;
+    std::vector<cSkinTaps> m_tapsY;
+
+    // node rows interpolated at the skin columns: positions and derivatives
+    // along x, one x/y/z plane each
+    std::vector<float> m_rowPos[3];
+    std::vector<float> m_rowDu[3];
+
+    // skin positions and normals, one x/y/z plane each
+    std::vector<float> m_pos[3];
+    std::vector<float> m_normal[3];
+
+    // skin triangle indices
+    cClothIndices m_indices;
+};
@@ -0,0 +1,178 @@
+//------------------------------------------------------------------------------
+#include "clothSolver.h"
+//------------------------------------------------------------------------------
+using namespace chai3d;
+//------------------------------------------------------------------------------
+
+cClothSolver::cClothSolver(cClothModel* a_cloth)
+{
+    m_cloth = a_cloth;
+    m_numCollisions = 0;
+
+    m_pinned.resize(m_cloth->getNumNodes());
+    for (int y = 0; y < m_cloth->getNumNodesY(); y++)
+    {
+        for (int x = 0; x < m_cloth->getNumNodesX(); x++)
+        {
+            m_pinned[m_cloth->getNodeIndex(x, y)] = m_cloth->isPinned(x, y) ? 1 : 0;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+
+int cClothSolver::collide(double* a_x, double* a_y, double* a_z,
+    const double* a_x0, const double* a_y0, const double* a_z0, double a_dt)
+{
+    cClothCollisionState state;
+    state.m_numNodes = (int)m_pinned.size();
+    state.m_x = a_x;
+    state.m_y = a_y;
+    state.m_z = a_z;
+    state.m_x0 = a_x0;
+    state.m_y0 = a_y0;
+    state.m_z0 = a_z0;
+    state.m_pinned = &m_pinned[0];
+    state.m_dt = a_dt;
+
+    m_numCollisions = 0;
+    for (size_t i = 0; i < m_colliders.size(); i++)
+    {
+        m_numCollisions += m_colliders[i]->collide(state);
+    }
+    return (m_numCollisions);
+}
+
+//------------------------------------------------------------------------------
+
+cGELClothSolver::cGELClothSolver(cGELWorld* a_world, cClothModel* a_cloth) : cClothSolver(a_cloth)
+{
+    m_world = a_world;
+}
+
+//------------------------------------------------------------------------------
+
+void cGELClothSolver::clearExternalForces()
+{
+    m_world->clearExternalForces();
+}
+
+//------------------------------------------------------------------------------
+
+void cGELClothSolver::addExternalForce(int a_node, const cVector3d& a_force)
+{
+    cGELSkeletonNode* node = m_cloth->m_nodes[a_node];
+    node->setExternalForce(node->m_externalForce + a_force);
+}
+
+//------------------------------------------------------------------------------
+
+void cGELClothSolver::step(double a_dt)
+{
+    m_world->updateDynamics(a_dt);
+    if (m_colliders.empty() || (a_dt <= 0.0))
+    {
+        m_cloth->updatePositions();
+        return;
+    }
+
+    // hand the new skeleton positions to the collision stages, the previous
+    // ones are still in the cloth model
+    int numNodes = m_cloth->getNumNodes();
+    m_nx.resize(numNodes);
+    m_ny.resize(numNodes);
+    m_nz.resize(numNodes);
+    for (int i = 0; i < numNodes; i++)
+    {
+        const cVector3d& pos = m_cloth->m_nodes[i]->m_pos;
+        m_nx[i] = pos(0);
+        m_ny[i] = pos(1);
+        m_nz[i] = pos(2);
+    }
+
+    if (collide(&m_nx[0], &m_ny[0], &m_nz[0], &m_cloth->m_px[0], &m_cloth->m_py[0], &m_cloth->m_pz[0], a_dt) > 0)
+    {
+        // move corrected nodes and take their velocity from the corrected motion
+        for (int i = 0; i < numNodes; i++)
+        {
+            cGELSkeletonNode* node = m_cloth->m_nodes[i];
+            cVector3d pos(m_nx[i], m_ny[i], m_nz[i]);
+            if (!pos.equals(node->m_pos))
+            {
+                node->m_pos = pos;
+                node->m_vel = (pos - cVector3d(m_cloth->m_px[i], m_cloth->m_py[i], m_cloth->m_pz[i])) / a_dt;
+            }
+        }
+    }
+
+    m_cloth->m_px.swap(m_nx);
+    m_cloth->m_py.swap(m_ny);
+    m_cloth->m_pz.swap(m_nz);
+}
+
+//------------------------------------------------------------------------------
+
+void cGELClothSolver::getVelocities(double* a_vx, double* a_vy, double* a_vz) const
+{
+    int numNodes = m_cloth->getNumNodes();
+    for (int i = 0; i < numNodes; i++)
+    {
+        const cVector3d& vel = m_cloth->m_nodes[i]->m_vel;
+        a_vx[i] = vel(0);
+        a_vy[i] = vel(1);
+        a_vz[i] = vel(2);
+    }
+}
+
+//------------------------------------------------------------------------------
+
+void cGELClothSolver::setState(const double* a_x, const double* a_y, const double* a_z,
+    const double* a_vx, const double* a_vy, const double* a_vz, const char* a_pinned)
+{
+    int numNodes = m_cloth->getNumNodes();
+    for (int i = 0; i < numNodes; i++)
+    {
+        cGELSkeletonNode* node = m_cloth->m_nodes[i];
+        node->m_pos.set(a_x[i], a_y[i], a_z[i]);
+        node->m_vel.set(a_vx[i], a_vy[i], a_vz[i]);
+        node->m_fixed = (a_pinned[i] != 0);
+        m_pinned[i] = a_pinned[i] ? 1 : 0;
+    }
+    m_cloth->updatePositions();
+}
+
+//------------------------------------------------------------------------------
+
+void cGELClothSolver::getNodeState(double* a_state) const
+{
+    int numNodes = m_cloth->getNumNodes();
+    for (int i = 0; i < numNodes; i++)
+    {
+        const cGELSkeletonNode* node = m_cloth->m_nodes[i];
+        double* state = a_state + 12 * i;
+        for (int r = 0; r < 3; r++)
+        {
+            for (int c = 0; c < 3; c++)
+            {
+                state[3 * r + c] = node->m_rot(r, c);
+            }
+            state[9 + r] = node->m_angVel(r);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+
+void cGELClothSolver::setNodeState(const double* a_state)
+{
+    int numNodes = m_cloth->getNumNodes();
+    for (int i = 0; i < numNodes; i++)
+    {
+        cGELSkeletonNode* node = m_cloth->m_nodes[i];
+        const double* state = a_state + 12 * i;
+        node->m_rot.set(state[0], state[1], state[2],
+                        state[3], state[4], state[5],
+                        state[6], state[7], state[8]);
+        node->m_angVel.set(state[9], state[10], state[11]);
+    }
+}
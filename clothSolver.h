@@ -0,0 +1,121 @@
+#pragma once
+
+#include "cloth.h"
+#include "clothCollision.h"
+
+#include <vector>
+
+//------------------------------------------------------------------------------
+// DECLARED TYPES
+//------------------------------------------------------------------------------
+
+// cloth dynamics engine. external forces are accumulated between steps, and
+// each step leaves the new node positions in the position arrays of the cloth
+// model, which the contact and rendering paths read. the collision stages run
+// at the end of every step, before the node velocities are final.
+class cClothSolver
+{
+public:
+
+    // constructor
+    cClothSolver(cClothModel* a_cloth);
+
+    // destructor
+    virtual ~cClothSolver() {}
+
+    // short name of the solver
+    virtual const char* getName() const = 0;
+
+    // reset the external forces of all nodes
+    virtual void clearExternalForces() = 0;
+
+    // add a_force to the external force of node a_node
+    virtual void addExternalForce(int a_node, const chai3d::cVector3d& a_force) = 0;
+
+    // advance the cloth by a_dt seconds
+    virtual void step(double a_dt) = 0;
+
+    // copy the node velocities into a_vx/y/z
+    virtual void getVelocities(double* a_vx, double* a_vy, double* a_vz) const = 0;
+
+    // restart from positions a_x/y/z and velocities a_vx/y/z, holding the
+    // nodes flagged in a_pinned in place
+    virtual void setState(const double* a_x, const double* a_y, const double* a_z,
+        const double* a_vx, const double* a_vy, const double* a_vz, const char* a_pinned) = 0;
+
+    // number of solver specific state values per node, beyond positions and
+    // velocities
+    virtual int getNumNodeState() const { return (0); }
+
+    // copy the solver specific state, getNumNodeState() values per node
+    virtual void getNodeState(double* /*a_state*/) const {}
+
+    // restore the solver specific state, after setState()
+    virtual void setNodeState(const double* /*a_state*/) {}
+
+    // 1 for pinned nodes
+    const std::vector<char>& getPinned() const { return (m_pinned); }
+
+    // add a collision stage (not owned)
+    void addCollider(cClothCollider* a_collider) { m_colliders.push_back(a_collider); }
+
+    // number of node contacts found by the collision stages at the last step
+    int getNumCollisions() const { return (m_numCollisions); }
+
+protected:
+
+    // run the collision stages on end of step positions a_x/y/z, from start
+    // of step positions a_x0/y0/z0, returns the number of node contacts
+    int collide(double* a_x, double* a_y, double* a_z,
+        const double* a_x0, const double* a_y0, const double* a_z0, double a_dt);
+
+protected:
+
+    // cloth model
+    cClothModel* m_cloth;
+
+    // 1 for pinned nodes
+    std::vector<char> m_pinned;
+
+    // collision stages
+    std::vector<cClothCollider*> m_colliders;
+
+    // node contacts of the last step
+    int m_numCollisions;
+};
+
+//------------------------------------------------------------------------------
+
+// GEL skeleton model: one cGELSkeletonNode per node, one cGELSkeletonLink per
+// structural link, integrated by the GEL world
+class cGELClothSolver : public cClothSolver
+{
+public:
+
+    // constructor, the skeleton of a_cloth must already be built inside a_world
+    cGELClothSolver(chai3d::cGELWorld* a_world, cClothModel* a_cloth);
+
+    virtual const char* getName() const { return ("gel"); }
+    virtual void clearExternalForces();
+    virtual void addExternalForce(int a_node, const chai3d::cVector3d& a_force);
+    virtual void step(double a_dt);
+    virtual void getVelocities(double* a_vx, double* a_vy, double* a_vz) const;
+    virtual void setState(const double* a_x, const double* a_y, const double* a_z,
+        const double* a_vx, const double* a_vy, const double* a_vz, const char* a_pinned);
+
+    // node orientation (row major) and angular velocity, the flexion and
+    // torsion links are only at rest with the orientations they settled with
+    virtual int getNumNodeState() const { return (12); }
+    virtual void getNodeState(double* a_state) const;
+    virtual void setNodeState(const double* a_state);
+
+protected:
+
+    // deformable world holding the skeleton
+    chai3d::cGELWorld* m_world;
+
+    // end of step positions handed to the collision stages
+    std::vector<double> m_nx;
+    std::vector<double> m_ny;
+    std::vector<double> m_nz;
+};
@@ -0,0 +1,144 @@
+//------------------------------------------------------------------------------
+#include "clothState.h"
+#include "mappedFile.h"
+//------------------------------------------------------------------------------
+#include <cstdio>
+#include <cstring>
+//------------------------------------------------------------------------------
+using namespace chai3d;
+//------------------------------------------------------------------------------
+
+// the node arrays follow the header at a fixed offset
+static const size_t C_CLOTH_STATE_DATA_OFFSET = 128;
+
+static_assert(sizeof(cClothStateHeader) <= C_CLOTH_STATE_DATA_OFFSET, "cloth state header too large");
+
+//------------------------------------------------------------------------------
+
+// size of a state file for a_numNodes nodes with a_numNodeState solver
+// values each
+static size_t stateSize(size_t a_numNodes, size_t a_numNodeState)
+{
+    return (C_CLOTH_STATE_DATA_OFFSET + (6 + a_numNodeState) * a_numNodes * sizeof(double) + a_numNodes);
+}
+
+//------------------------------------------------------------------------------
+
+// FNV-1a over the bytes of a value
+template <class T> static void hashValue(unsigned long long& a_hash, const T& a_value)
+{
+    const unsigned char* bytes = (const unsigned char*)&a_value;
+    for (size_t i = 0; i < sizeof(T); i++)
+    {
+        a_hash = (a_hash ^ bytes[i]) * 1099511628211ULL;
+    }
+}
+
+//------------------------------------------------------------------------------
+
+unsigned long long cComputeClothStateKey(const cClothParams& a_params, const std::string& a_solver, unsigned int a_scene)
+{
+    unsigned long long hash = 14695981039346656037ULL;
+    hashValue(hash, C_CLOTH_STATE_VERSION);
+    hashValue(hash, a_params.numX);
+    hashValue(hash, a_params.numY);
+    hashValue(hash, a_params.size);
+    hashValue(hash, a_params.height);
+    hashValue(hash, a_params.nodeRadius);
+    hashValue(hash, a_params.nodeMass);
+    hashValue(hash, a_params.kDampingPos);
+    hashValue(hash, a_params.kDampingRot);
+    hashValue(hash, a_params.gravity);
+    hashValue(hash, a_params.kSpringElongation);
+    hashValue(hash, a_params.kSpringFlexion);
+    hashValue(hash, a_params.kSpringTorsion);
+    hashValue(hash, a_params.solverIterations);
+    hashValue(hash, a_params.bendCompliance);
+    hashValue(hash, a_params.velocityDamping);
+    hashValue(hash, a_params.cgMaxIterations);
+    hashValue(hash, a_params.cgTolerance);
+    for (size_t i = 0; i < a_solver.size(); i++)
+    {
+        hashValue(hash, a_solver[i]);
+    }
+    hashValue(hash, a_scene);
+    return (hash);
+}
+
+//------------------------------------------------------------------------------
+
+bool cSaveClothState(const std::string& a_filename, const cClothModel* a_cloth,
+    const cClothSolver* a_solver, unsigned long long a_key, double a_time)
+{
+    // write a temporary file, so that a reader never maps a partial state
+    std::string filename = a_filename + ".tmp";
+    size_t numNodes = a_cloth->getNumNodes();
+    size_t numNodeState = a_solver->getNumNodeState();
+    cMappedFile file;
+    if (!file.create(filename, stateSize(numNodes, numNodeState)))
+    {
+        return (false);
+    }
+
+    unsigned char* data = (unsigned char*)file.getData();
+    cClothStateHeader* header = (cClothStateHeader*)data;
+    memset(header, 0, sizeof(cClothStateHeader));
+    memcpy(header->m_magic, "CLOTHSTA", 8);
+    header->m_version = C_CLOTH_STATE_VERSION;
+    header->m_numNodes = (unsigned int)numNodes;
+    header->m_numNodeState = (unsigned int)numNodeState;
+    header->m_numX = a_cloth->m_params.numX;
+    header->m_numY = a_cloth->m_params.numY;
+    header->m_key = a_key;
+    strncpy(header->m_solver, a_solver->getName(), sizeof(header->m_solver) - 1);
+    header->m_time = a_time;
+    header->m_size = a_cloth->m_params.size;
+
+    double* arrays = (double*)(data + C_CLOTH_STATE_DATA_OFFSET);
+    memcpy(arrays + 0 * numNodes, &a_cloth->m_px[0], numNodes * sizeof(double));
+    memcpy(arrays + 1 * numNodes, &a_cloth->m_py[0], numNodes * sizeof(double));
+    memcpy(arrays + 2 * numNodes, &a_cloth->m_pz[0], numNodes * sizeof(double));
+    a_solver->getVelocities(arrays + 3 * numNodes, arrays + 4 * numNodes, arrays + 5 * numNodes);
+    a_solver->getNodeState(arrays + 6 * numNodes);
+    memcpy(arrays + (6 + numNodeState) * numNodes, &a_solver->getPinned()[0], numNodes);
+    file.close();
+
+    remove(a_filename.c_str());
+    return (rename(filename.c_str(), a_filename.c_str()) == 0);
+}
+
+//------------------------------------------------------------------------------
+
+bool cLoadClothState(const std::string& a_filename, cClothModel* a_cloth,
+    cClothSolver* a_solver, unsigned long long a_key)
+{
+    cMappedFile file;
+    if (!file.open(a_filename) || (file.getSize() < C_CLOTH_STATE_DATA_OFFSET))
+    {
+        return (false);
+    }
+
+    // the key covers the grid, the header guards against damaged files
+    const unsigned char* data = (const unsigned char*)file.getData();
+    const cClothStateHeader* header = (const cClothStateHeader*)data;
+    size_t numNodes = a_cloth->getNumNodes();
+    size_t numNodeState = a_solver->getNumNodeState();
+    if ((memcmp(header->m_magic, "CLOTHSTA", 8) != 0) ||
+        (header->m_version != C_CLOTH_STATE_VERSION) ||
+        (header->m_key != a_key) ||
+        (header->m_numNodes != numNodes) ||
+        (header->m_numNodeState != numNodeState) ||
+        (file.getSize() < stateSize(numNodes, numNodeState)))
+    {
+        return (false);
+    }
+
+    // the solver copies the node arrays straight from the mapping
+    const double* arrays = (const double*)(data + C_CLOTH_STATE_DATA_OFFSET);
+    a_solver->setState(arrays + 0 * numNodes, arrays + 1 * numNodes, arrays + 2 * numNodes,
+        arrays + 3 * numNodes, arrays + 4 * numNodes, arrays + 5 * numNodes,
+        (const char*)(arrays + (6 + numNodeState) * numNodes));
+    a_solver->setNodeState(arrays + 6 * numNodes);
+
+    return (true);
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "cloth.h"
+#include "clothSolver.h"
+
+#include <string>
+
+//------------------------------------------------------------------------------
+// DECLARED TYPES
+//------------------------------------------------------------------------------
+
+// version of the cloth state layout
+const unsigned int C_CLOTH_STATE_VERSION = 2;
+
+// header at the start of a cloth state file. it is followed by the node
+// positions and velocities, six arrays of doubles, then by the solver
+// specific state of each node (m_numNodeState doubles per node), then by one
+// pinned flag byte per node.
+struct cClothStateHeader
+{
+    // "CLOTHSTA" and layout version
+    char m_magic[8];
+    unsigned int m_version;
+
+    // number of nodes and grid cells
+    unsigned int m_numNodes;
+    unsigned int m_numNodeState;
+    int m_numX;
+    int m_numY;
+
+    // key of the parameters the state was computed with
+    unsigned long long m_key;
+
+    // solver that computed the state
+    char m_solver[16];
+
+    // simulated time since the cloth was released [s]
+    double m_time;
+
+    // cloth edge length [m]
+    double m_size;
+};
+
+//------------------------------------------------------------------------------
+// DECLARED FUNCTIONS
+//------------------------------------------------------------------------------
+
+// key of everything a settled state depends on: the grid and material
+// parameters, the solver and a_scene, flags of the other objects in the scene
+unsigned long long cComputeClothStateKey(const cClothParams& a_params, const std::string& a_solver, unsigned int a_scene);
+
+// write the state of a_solver to a_filename, replacing it only once complete
+bool cSaveClothState(const std::string& a_filename, const cClothModel* a_cloth,
+    const cClothSolver* a_solver, unsigned long long a_key, double a_time);
+
+// restore a_solver from a_filename, returns false (and leaves the cloth
+// untouched) if the file is missing or was saved with another key
+bool cLoadClothState(const std::string& a_filename, cClothModel* a_cloth,
+    cClothSolver* a_solver, unsigned long long a_key);
@@ -0,0 +1,330 @@
+//------------------------------------------------------------------------------
+#include "clothXPBD.h"
+//------------------------------------------------------------------------------
+#include <algorithm>
+#include <cmath>
+//------------------------------------------------------------------------------
+using namespace chai3d;
+//------------------------------------------------------------------------------
+
+// items per chunk handed to the thread pool
+static const int C_NODE_GRAIN = 1024;
+static const int C_CONSTRAINT_GRAIN = 512;
+
+//------------------------------------------------------------------------------
+
+cXPBDClothSolver::cXPBDClothSolver(cClothModel* a_cloth) : cClothSolver(a_cloth)
+{
+    m_pool = NULL;
+
+    // node state, starting at rest
+    int numNodes = m_cloth->getNumNodes();
+    m_cloth->m_px.resize(numNodes);
+    m_cloth->m_py.resize(numNodes);
+    m_cloth->m_pz.resize(numNodes);
+    m_qx.resize(numNodes);
+    m_qy.resize(numNodes);
+    m_qz.resize(numNodes);
+    m_vx.assign(numNodes, 0.0);
+    m_vy.assign(numNodes, 0.0);
+    m_vz.assign(numNodes, 0.0);
+    m_fx.assign(numNodes, 0.0);
+    m_fy.assign(numNodes, 0.0);
+    m_fz.assign(numNodes, 0.0);
+    m_invMass.resize(numNodes);
+
+    const cClothParams& params = m_cloth->m_params;
+    for (int y = 0; y < m_cloth->getNumNodesY(); y++)
+    {
+        for (int x = 0; x < m_cloth->getNumNodesX(); x++)
+        {
+            int i = m_cloth->getNodeIndex(x, y);
+            cVector3d pos = m_cloth->getRestPos(x, y);
+            m_cloth->m_px[i] = pos(0);
+            m_cloth->m_py[i] = pos(1);
+            m_cloth->m_pz[i] = pos(2);
+            m_invMass[i] = m_cloth->isPinned(x, y) ? 0.0 : 1.0 / params.nodeMass;
+        }
+    }
+
+    // stretch constraints, as stiff as the skeleton links
+    m_cloth->buildLinks();
+    double stretchCompliance = 1.0 / params.kSpringElongation;
+    for (size_t i = 0; i < m_cloth->m_links.size(); i++)
+    {
+        addConstraint(m_cloth->m_links[i].m_node0, m_cloth->m_links[i].m_node1, stretchCompliance);
+    }
+
+    // bending constraints across two cells
+    for (int y = 0; y < m_cloth->getNumNodesY(); y++)
+    {
+        for (int x = 0; x < m_cloth->getNumNodesX(); x++)
+        {
+            if (x + 2 < m_cloth->getNumNodesX())
+            {
+                addConstraint(m_cloth->getNodeIndex(x, y), m_cloth->getNodeIndex(x + 2, y), params.bendCompliance);
+            }
+            if (y + 2 < m_cloth->getNumNodesY())
+            {
+                addConstraint(m_cloth->getNodeIndex(x, y), m_cloth->getNodeIndex(x, y + 2), params.bendCompliance);
+            }
+        }
+    }
+    m_lambda.assign(m_rest.size(), 0.0);
+
+    colorConstraints();
+}
+
+//------------------------------------------------------------------------------
+
+void cXPBDClothSolver::colorConstraints()
+{
+    int numConstraints = (int)m_rest.size();
+
+    // colors used by the constraints of each node
+    std::vector<unsigned long long> used(m_invMass.size(), 0);
+    std::vector<int> color(numConstraints);
+    int numColors = 0;
+    for (int c = 0; c < numConstraints; c++)
+    {
+        unsigned long long mask = used[m_node0[c]] | used[m_node1[c]];
+        int k = 0;
+        while ((k < 63) && (mask & (1ULL << k)))
+        {
+            k++;
+        }
+        color[c] = k;
+        used[m_node0[c]] |= (1ULL << k);
+        used[m_node1[c]] |= (1ULL << k);
+        numColors = std::max(numColors, k + 1);
+    }
+
+    // stable counting sort by color
+    m_colorStart.assign(numColors + 1, 0);
+    for (int c = 0; c < numConstraints; c++)
+    {
+        m_colorStart[color[c] + 1]++;
+    }
+    for (int k = 0; k < numColors; k++)
+    {
+        m_colorStart[k + 1] += m_colorStart[k];
+    }
+
+    std::vector<int> order(numConstraints);
+    std::vector<int> next(m_colorStart.begin(), m_colorStart.end() - 1);
+    for (int c = 0; c < numConstraints; c++)
+    {
+        order[next[color[c]]++] = c;
+    }
+
+    std::vector<int> node0(numConstraints);
+    std::vector<int> node1(numConstraints);
+    std::vector<double> rest(numConstraints);
+    std::vector<double> compliance(numConstraints);
+    for (int c = 0; c < numConstraints; c++)
+    {
+        node0[c] = m_node0[order[c]];
+        node1[c] = m_node1[order[c]];
+        rest[c] = m_rest[order[c]];
+        compliance[c] = m_compliance[order[c]];
+    }
+    m_node0.swap(node0);
+    m_node1.swap(node1);
+    m_rest.swap(rest);
+    m_compliance.swap(compliance);
+}
+
+//------------------------------------------------------------------------------
+
+void cXPBDClothSolver::parallelFor(int a_count, int a_grain, const std::function<void(int, int)>& a_function)
+{
+    if (m_pool != NULL)
+    {
+        m_pool->parallelFor(0, a_count, a_grain, a_function);
+    }
+    else
+    {
+        a_function(0, a_count);
+    }
+}
+
+//------------------------------------------------------------------------------
+
+void cXPBDClothSolver::addConstraint(int a_node0, int a_node1, double a_compliance)
+{
+    double dx = m_cloth->m_px[a_node1] - m_cloth->m_px[a_node0];
+    double dy = m_cloth->m_py[a_node1] - m_cloth->m_py[a_node0];
+    double dz = m_cloth->m_pz[a_node1] - m_cloth->m_pz[a_node0];
+
+    m_node0.push_back(a_node0);
+    m_node1.push_back(a_node1);
+    m_rest.push_back(sqrt(dx * dx + dy * dy + dz * dz));
+    m_compliance.push_back(a_compliance);
+}
+
+//------------------------------------------------------------------------------
+
+void cXPBDClothSolver::clearExternalForces()
+{
+    std::fill(m_fx.begin(), m_fx.end(), 0.0);
+    std::fill(m_fy.begin(), m_fy.end(), 0.0);
+    std::fill(m_fz.begin(), m_fz.end(), 0.0);
+}
+
+//------------------------------------------------------------------------------
+
+void cXPBDClothSolver::addExternalForce(int a_node, const cVector3d& a_force)
+{
+    m_fx[a_node] += a_force(0);
+    m_fy[a_node] += a_force(1);
+    m_fz[a_node] += a_force(2);
+}
+
+//------------------------------------------------------------------------------
+
+void cXPBDClothSolver::step(double a_dt)
+{
+    if (a_dt <= 0.0)
+    {
+        return;
+    }
+
+    const cClothParams& params = m_cloth->m_params;
+    double* px = &m_cloth->m_px[0];
+    double* py = &m_cloth->m_py[0];
+    double* pz = &m_cloth->m_pz[0];
+    int numNodes = (int)m_invMass.size();
+
+    // predict positions from gravity, external forces and damping
+    double damping = 1.0 / (1.0 + params.velocityDamping * a_dt);
+    parallelFor(numNodes, C_NODE_GRAIN, [&](int a_begin, int a_end)
+    {
+        for (int i = a_begin; i < a_end; i++)
+        {
+            double w = m_invMass[i];
+            if (w > 0.0)
+            {
+                m_vx[i] = (m_vx[i] + a_dt * w * m_fx[i]) * damping;
+                m_vy[i] = (m_vy[i] + a_dt * (params.gravity + w * m_fy[i])) * damping;
+                m_vz[i] = (m_vz[i] + a_dt * w * m_fz[i]) * damping;
+            }
+            m_qx[i] = px[i] + a_dt * m_vx[i];
+            m_qy[i] = py[i] + a_dt * m_vy[i];
+            m_qz[i] = pz[i] + a_dt * m_vz[i];
+        }
+    });
+
+    // project constraints
+    std::fill(m_lambda.begin(), m_lambda.end(), 0.0);
+    for (int k = 0; k < params.solverIterations; k++)
+    {
+        solveConstraints(a_dt);
+    }
+
+    // collisions, the velocities below include their correction
+    collide(&m_qx[0], &m_qy[0], &m_qz[0], px, py, pz, a_dt);
+
+    // velocities from the position change
+    double invDt = 1.0 / a_dt;
+    parallelFor(numNodes, C_NODE_GRAIN, [&](int a_begin, int a_end)
+    {
+        for (int i = a_begin; i < a_end; i++)
+        {
+            m_vx[i] = (m_qx[i] - px[i]) * invDt;
+            m_vy[i] = (m_qy[i] - py[i]) * invDt;
+            m_vz[i] = (m_qz[i] - pz[i]) * invDt;
+        }
+    });
+
+    // predicted positions become the current positions
+    m_cloth->m_px.swap(m_qx);
+    m_cloth->m_py.swap(m_qy);
+    m_cloth->m_pz.swap(m_qz);
+}
+
+//------------------------------------------------------------------------------
+
+void cXPBDClothSolver::solveConstraints(double a_dt)
+{
+    double invDt2 = 1.0 / (a_dt * a_dt);
+
+    // colors run one after the other, the pool returns only once a color is done
+    for (int k = 0; k < getNumColors(); k++)
+    {
+        int first = m_colorStart[k];
+        parallelFor(m_colorStart[k + 1] - first, C_CONSTRAINT_GRAIN, [&](int a_begin, int a_end)
+        {
+            solveRange(first + a_begin, first + a_end, invDt2);
+        });
+    }
+}
+
+//------------------------------------------------------------------------------
+
+void cXPBDClothSolver::solveRange(int a_begin, int a_end, double a_invDt2)
+{
+    for (int c = a_begin; c < a_end; c++)
+    {
+        int i0 = m_node0[c];
+        int i1 = m_node1[c];
+        double w0 = m_invMass[i0];
+        double w1 = m_invMass[i1];
+        if (w0 + w1 <= 0.0)
+        {
+            continue;
+        }
+
+        double dx = m_qx[i1] - m_qx[i0];
+        double dy = m_qy[i1] - m_qy[i0];
+        double dz = m_qz[i1] - m_qz[i0];
+        double length = sqrt(dx * dx + dy * dy + dz * dz);
+        if (length < 1e-9)
+        {
+            continue;
+        }
+
+        // multiplier update, the gradient is +n on node 1 and -n on node 0
+        double alpha = m_compliance[c] * a_invDt2;
+        double C = length - m_rest[c];
+        double dLambda = (-C - alpha * m_lambda[c]) / (w0 + w1 + alpha);
+        m_lambda[c] += dLambda;
+
+        double s = dLambda / length;
+        m_qx[i0] -= w0 * s * dx;
+        m_qy[i0] -= w0 * s * dy;
+        m_qz[i0] -= w0 * s * dz;
+        m_qx[i1] += w1 * s * dx;
+        m_qy[i1] += w1 * s * dy;
+        m_qz[i1] += w1 * s * dz;
+    }
+}
+
+//------------------------------------------------------------------------------
+
+void cXPBDClothSolver::getVelocities(double* a_vx, double* a_vy, double* a_vz) const
+{
+    std::copy(m_vx.begin(), m_vx.end(), a_vx);
+    std::copy(m_vy.begin(), m_vy.end(), a_vy);
+    std::copy(m_vz.begin(), m_vz.end(), a_vz);
+}
+
+//------------------------------------------------------------------------------
+
+void cXPBDClothSolver::setState(const double* a_x, const double* a_y, const double* a_z,
+    const double* a_vx, const double* a_vy, const double* a_vz, const char* a_pinned)
+{
+    int numNodes = (int)m_invMass.size();
+    std::copy(a_x, a_x + numNodes, m_cloth->m_px.begin());
+    std::copy(a_y, a_y + numNodes, m_cloth->m_py.begin());
+    std::copy(a_z, a_z + numNodes, m_cloth->m_pz.begin());
+    std::copy(a_vx, a_vx + numNodes, m_vx.begin());
+    std::copy(a_vy, a_vy + numNodes, m_vy.begin());
+    std::copy(a_vz, a_vz + numNodes, m_vz.begin());
+
+    double invMass = 1.0 / m_cloth->m_params.nodeMass;
+    for (int i = 0; i < numNodes; i++)
+    {
+        m_pinned[i] = a_pinned[i] ? 1 : 0;
+        m_invMass[i] = m_pinned[i] ? 0.0 : invMass;
+    }
+}
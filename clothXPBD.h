@@ -0,0 +1,104 @@
+#pragma once
+
+#include "clothSolver.h"
+#include "threadPool.h"
+
+#include <functional>
+#include <vector>
+
+//------------------------------------------------------------------------------
+// DECLARED TYPES
+//------------------------------------------------------------------------------
+
+// extended position based dynamics (XPBD) cloth. nodes carry a position, a
+// velocity and an inverse mass only, and the cloth is held together by
+// distance constraints: one per structural link, plus bending constraints
+// between nodes two cells apart along x and z. all state is stored in
+// contiguous arrays indexed by node or constraint.
+//
+// constraints are sorted into colors such that no two constraints of one
+// color share a node. a color can then be solved in any order, or in
+// parallel, with the same result, so a step is deterministic whatever the
+// number of threads.
+class cXPBDClothSolver : public cClothSolver
+{
+public:
+
+    // constructor, builds the constraints of a_cloth and resets its
+    // positions to the rest shape
+    cXPBDClothSolver(cClothModel* a_cloth);
+
+    virtual const char* getName() const { return ("xpbd"); }
+    virtual void clearExternalForces();
+    virtual void addExternalForce(int a_node, const chai3d::cVector3d& a_force);
+    virtual void step(double a_dt);
+    virtual void getVelocities(double* a_vx, double* a_vy, double* a_vz) const;
+    virtual void setState(const double* a_x, const double* a_y, const double* a_z,
+        const double* a_vx, const double* a_vy, const double* a_vz, const char* a_pinned);
+
+    // number of distance constraints
+    int getNumConstraints() const { return ((int)m_rest.size()); }
+
+    // number of constraint colors
+    int getNumColors() const { return ((int)m_colorStart.size() - 1); }
+
+    // solve on a_pool, or on the calling thread if NULL (not owned)
+    void setThreadPool(cThreadPool* a_pool) { m_pool = a_pool; }
+
+protected:
+
+    // add a distance constraint between two nodes at their rest distance
+    void addConstraint(int a_node0, int a_node1, double a_compliance);
+
+    // sort constraints by color, greedily giving each constraint the first
+    // color not used by its two nodes
+    void colorConstraints();
+
+    // solve all constraints once on the predicted positions, color by color
+    void solveConstraints(double a_dt);
+
+    // solve constraints [a_begin, a_end)
+    void solveRange(int a_begin, int a_end, double a_invDt2);
+
+    // call a_function over [0, a_count), split on the thread pool if any
+    void parallelFor(int a_count, int a_grain, const std::function<void(int, int)>& a_function);
+
+protected:
+
+    // predicted positions
+    std::vector<double> m_qx;
+    std::vector<double> m_qy;
+    std::vector<double> m_qz;
+
+    // velocities
+    std::vector<double> m_vx;
+    std::vector<double> m_vy;
+    std::vector<double> m_vz;
+
+    // external forces
+    std::vector<double> m_fx;
+    std::vector<double> m_fy;
+    std::vector<double> m_fz;
+
+    // inverse masses, 0 for pinned nodes
+    std::vector<double> m_invMass;
+
+    // constraint nodes
+    std::vector<int> m_node0;
+    std::vector<int> m_node1;
+
+    // constraint rest lengths [m]
+    std::vector<double> m_rest;
+
+    // constraint compliances [m/N]
+    std::vector<double> m_compliance;
+
+    // accumulated constraint multipliers of the current step
+    std::vector<double> m_lambda;
+
+    // first constraint of each color, followed by the number of constraints
+    std::vector<int> m_colorStart;
+
+    // thread pool, or NULL
+    cThreadPool* m_pool;
+};
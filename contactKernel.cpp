@@ -0,0 +1,555 @@
+//------------------------------------------------------------------------------
+#include "contactKernel.h"
+//------------------------------------------------------------------------------
+#include <algorithm>
+#if defined(C_CONTACT_USE_AVX)
+#include <immintrin.h>
+#elif defined(C_CONTACT_USE_SSE2)
+#include <emmintrin.h>
+#endif
+//------------------------------------------------------------------------------
+using namespace chai3d;
+//------------------------------------------------------------------------------
+
+// nodes closer than this distance to the tool center produce no force
+static const double C_CONTACT_MIN_DISTANCE = 0.0000001;
+
+//------------------------------------------------------------------------------
+
+void cContactBatch::resize(int a_count)
+{
+    m_count = a_count;
+    m_index.resize(a_count);
+    m_x.resize(a_count);
+    m_y.resize(a_count);
+    m_z.resize(a_count);
+    m_fx.resize(a_count);
+    m_fy.resize(a_count);
+    m_fz.resize(a_count);
+}
+
+//------------------------------------------------------------------------------
+
+// penalty force of a single node at offset (a_dx, a_dy, a_dz) from the closest
+// point of the tool, accumulated in lane i % C_CONTACT_LANES of a_sum
+static inline void penaltyNode(int i, double a_dx, double a_dy, double a_dz,
+    double a_contactRadius, double a_stiffness,
+    double* a_fx, double* a_fy, double* a_fz,
+    double a_sum[3][C_CONTACT_LANES])
+{
+    double d = sqrt(a_dx * a_dx + a_dy * a_dy + a_dz * a_dz);
+
+    double fx = 0.0, fy = 0.0, fz = 0.0;
+    if ((d >= C_CONTACT_MIN_DISTANCE) && (d <= a_contactRadius))
+    {
+        // penetration depth times stiffness along the normalized direction
+        double s = ((a_contactRadius - d) * a_stiffness) / d;
+        fx = a_dx * s;
+        fy = a_dy * s;
+        fz = a_dz * s;
+    }
+
+    // computed as (0 - f) like the vector paths, which never produce -0.0
+    a_fx[i] = 0.0 - fx;
+    a_fy[i] = 0.0 - fy;
+    a_fz[i] = 0.0 - fz;
+
+    int lane = i % C_CONTACT_LANES;
+    a_sum[0][lane] += fx;
+    a_sum[1][lane] += fy;
+    a_sum[2][lane] += fz;
+}
+
+//------------------------------------------------------------------------------
+
+// contact force of a single node against a sphere at a_cursor
+static inline void contactNode(int i,
+    const double* a_x, const double* a_y, const double* a_z,
+    const cVector3d& a_cursor, double a_contactRadius, double a_stiffness,
+    double* a_fx, double* a_fy, double* a_fz,
+    double a_sum[3][C_CONTACT_LANES])
+{
+    penaltyNode(i, a_cursor(0) - a_x[i], a_cursor(1) - a_y[i], a_cursor(2) - a_z[i],
+        a_contactRadius, a_stiffness, a_fx, a_fy, a_fz, a_sum);
+}
+
+//------------------------------------------------------------------------------
+
+// contact force of a single node against the segment from a_end0 along a_axis,
+// a_invLength2 is the inverse squared length of a_axis (zero for a point)
+static inline void capsuleNode(int i,
+    const double* a_x, const double* a_y, const double* a_z,
+    const cVector3d& a_end0, const cVector3d& a_axis, double a_invLength2,
+    double a_contactRadius, double a_stiffness,
+    double* a_fx, double* a_fy, double* a_fz,
+    double a_sum[3][C_CONTACT_LANES])
+{
+    // closest point of the segment
+    double px = a_x[i] - a_end0(0);
+    double py = a_y[i] - a_end0(1);
+    double pz = a_z[i] - a_end0(2);
+    double t = (px * a_axis(0) + py * a_axis(1) + pz * a_axis(2)) * a_invLength2;
+    t = std::min(std::max(t, 0.0), 1.0);
+
+    penaltyNode(i, (a_end0(0) + t * a_axis(0)) - a_x[i],
+                   (a_end0(1) + t * a_axis(1)) - a_y[i],
+                   (a_end0(2) + t * a_axis(2)) - a_z[i],
+        a_contactRadius, a_stiffness, a_fx, a_fy, a_fz, a_sum);
+}
+
+//------------------------------------------------------------------------------
+
+// reduce lane sums in a fixed order
+static inline cVector3d reduceLanes(const double a_sum[3][C_CONTACT_LANES])
+{
+    cVector3d result;
+    for (int k = 0; k < 3; k++)
+    {
+        result(k) = (a_sum[k][0] + a_sum[k][1]) + (a_sum[k][2] + a_sum[k][3]);
+    }
+    return (result);
+}
+
+//------------------------------------------------------------------------------
+
+cVector3d cComputeContactForcesScalar(const double* a_x,
+    const double* a_y,
+    const double* a_z,
+    int a_count,
+    const cVector3d& a_cursor,
+    double a_contactRadius,
+    double a_stiffness,
+    double* a_fx,
+    double* a_fy,
+    double* a_fz)
+{
+    double sum[3][C_CONTACT_LANES] = { { 0.0 } };
+    for (int i = 0; i < a_count; i++)
+    {
+        contactNode(i, a_x, a_y, a_z, a_cursor, a_contactRadius, a_stiffness, a_fx, a_fy, a_fz, sum);
+    }
+    return (reduceLanes(sum));
+}
+
+//------------------------------------------------------------------------------
+
+cVector3d cComputeContactForces(const double* a_x,
+    const double* a_y,
+    const double* a_z,
+    int a_count,
+    const cVector3d& a_cursor,
+    double a_contactRadius,
+    double a_stiffness,
+    double* a_fx,
+    double* a_fy,
+    double* a_fz)
+{
+#if defined(C_CONTACT_USE_AVX)
+
+    const __m256d cx = _mm256_set1_pd(a_cursor(0));
+    const __m256d cy = _mm256_set1_pd(a_cursor(1));
+    const __m256d cz = _mm256_set1_pd(a_cursor(2));
+    const __m256d radius = _mm256_set1_pd(a_contactRadius);
+    const __m256d stiffness = _mm256_set1_pd(a_stiffness);
+    const __m256d minDistance = _mm256_set1_pd(C_CONTACT_MIN_DISTANCE);
+    const __m256d zero = _mm256_setzero_pd();
+
+    __m256d sx = zero, sy = zero, sz = zero;
+
+    int i = 0;
+    for (; i + 4 <= a_count; i += 4)
+    {
+        __m256d dx = _mm256_sub_pd(cx, _mm256_loadu_pd(a_x + i));
+        __m256d dy = _mm256_sub_pd(cy, _mm256_loadu_pd(a_y + i));
+        __m256d dz = _mm256_sub_pd(cz, _mm256_loadu_pd(a_z + i));
+        __m256d d2 = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy)), _mm256_mul_pd(dz, dz));
+        __m256d d = _mm256_sqrt_pd(d2);
+
+        __m256d mask = _mm256_and_pd(_mm256_cmp_pd(d, minDistance, _CMP_GE_OQ), _mm256_cmp_pd(d, radius, _CMP_LE_OQ));
+        __m256d s = _mm256_div_pd(_mm256_mul_pd(_mm256_sub_pd(radius, d), stiffness), d);
+        s = _mm256_and_pd(s, mask);
+
+        __m256d fx = _mm256_mul_pd(dx, s);
+        __m256d fy = _mm256_mul_pd(dy, s);
+        __m256d fz = _mm256_mul_pd(dz, s);
+
+        _mm256_storeu_pd(a_fx + i, _mm256_sub_pd(zero, fx));
+        _mm256_storeu_pd(a_fy + i, _mm256_sub_pd(zero, fy));
+        _mm256_storeu_pd(a_fz + i, _mm256_sub_pd(zero, fz));
+
+        sx = _mm256_add_pd(sx, fx);
+        sy = _mm256_add_pd(sy, fy);
+        sz = _mm256_add_pd(sz, fz);
+    }
+
+    double sum[3][C_CONTACT_LANES];
+    _mm256_storeu_pd(sum[0], sx);
+    _mm256_storeu_pd(sum[1], sy);
+    _mm256_storeu_pd(sum[2], sz);
+
+#elif defined(C_CONTACT_USE_SSE2)
+
+    const __m128d cx = _mm_set1_pd(a_cursor(0));
+    const __m128d cy = _mm_set1_pd(a_cursor(1));
+    const __m128d cz = _mm_set1_pd(a_cursor(2));
+    const __m128d radius = _mm_set1_pd(a_contactRadius);
+    const __m128d stiffness = _mm_set1_pd(a_stiffness);
+    const __m128d minDistance = _mm_set1_pd(C_CONTACT_MIN_DISTANCE);
+    const __m128d zero = _mm_setzero_pd();
+
+    // lanes 0-1 and 2-3 of each group of four nodes
+    __m128d sx[2] = { zero, zero }, sy[2] = { zero, zero }, sz[2] = { zero, zero };
+
+    int i = 0;
+    for (; i + 4 <= a_count; i += 4)
+    {
+        for (int h = 0; h < 2; h++)
+        {
+            int k = i + 2 * h;
+            __m128d dx = _mm_sub_pd(cx, _mm_loadu_pd(a_x + k));
+            __m128d dy = _mm_sub_pd(cy, _mm_loadu_pd(a_y + k));
+            __m128d dz = _mm_sub_pd(cz, _mm_loadu_pd(a_z + k));
+            __m128d d2 = _mm_add_pd(_mm_add_pd(_mm_mul_pd(dx, dx), _mm_mul_pd(dy, dy)), _mm_mul_pd(dz, dz));
+            __m128d d = _mm_sqrt_pd(d2);
+
+            __m128d mask = _mm_and_pd(_mm_cmpge_pd(d, minDistance), _mm_cmple_pd(d, radius));
+            __m128d s = _mm_div_pd(_mm_mul_pd(_mm_sub_pd(radius, d), stiffness), d);
+            s = _mm_and_pd(s, mask);
+
+            __m128d fx = _mm_mul_pd(dx, s);
+            __m128d fy = _mm_mul_pd(dy, s);
+            __m128d fz = _mm_mul_pd(dz, s);
+
+            _mm_storeu_pd(a_fx + k, _mm_sub_pd(zero, fx));
+            _mm_storeu_pd(a_fy + k, _mm_sub_pd(zero, fy));
+            _mm_storeu_pd(a_fz + k, _mm_sub_pd(zero, fz));
+
+            sx[h] = _mm_add_pd(sx[h], fx);
+            sy[h] = _mm_add_pd(sy[h], fy);
+            sz[h] = _mm_add_pd(sz[h], fz);
+        }
+    }
+
+    double sum[3][C_CONTACT_LANES];
+    _mm_storeu_pd(sum[0] + 0, sx[0]); _mm_storeu_pd(sum[0] + 2, sx[1]);
+    _mm_storeu_pd(sum[1] + 0, sy[0]); _mm_storeu_pd(sum[1] + 2, sy[1]);
+    _mm_storeu_pd(sum[2] + 0, sz[0]); _mm_storeu_pd(sum[2] + 2, sz[1]);
+
+#else
+
+    double sum[3][C_CONTACT_LANES] = { { 0.0 } };
+    int i = 0;
+
+#endif
+
+    // remaining nodes
+    for (; i < a_count; i++)
+    {
+        contactNode(i, a_x, a_y, a_z, a_cursor, a_contactRadius, a_stiffness, a_fx, a_fy, a_fz, sum);
+    }
+
+    return (reduceLanes(sum));
+}
+
+//------------------------------------------------------------------------------
+
+cVector3d cComputeContactForces(cContactBatch& a_batch,
+    const cVector3d& a_cursor,
+    double a_contactRadius,
+    double a_stiffness)
+{
+    if (a_batch.m_count == 0)
+    {
+        return (cVector3d(0.0, 0.0, 0.0));
+    }
+
+    return (cComputeContactForces(&a_batch.m_x[0], &a_batch.m_y[0], &a_batch.m_z[0], a_batch.m_count,
+        a_cursor, a_contactRadius, a_stiffness,
+        &a_batch.m_fx[0], &a_batch.m_fy[0], &a_batch.m_fz[0]));
+}
+
+//------------------------------------------------------------------------------
+
+cVector3d cComputeCapsuleContactForcesScalar(const double* a_x,
+    const double* a_y,
+    const double* a_z,
+    int a_count,
+    const cVector3d& a_end0,
+    const cVector3d& a_end1,
+    double a_contactRadius,
+    double a_stiffness,
+    double* a_fx,
+    double* a_fy,
+    double* a_fz)
+{
+    cVector3d axis = a_end1 - a_end0;
+    double length2 = axis.lengthsq();
+    double invLength2 = (length2 > 0.0) ? 1.0 / length2 : 0.0;
+
+    double sum[3][C_CONTACT_LANES] = { { 0.0 } };
+    for (int i = 0; i < a_count; i++)
+    {
+        capsuleNode(i, a_x, a_y, a_z, a_end0, axis, invLength2, a_contactRadius, a_stiffness, a_fx, a_fy, a_fz, sum);
+    }
+    return (reduceLanes(sum));
+}
+
+//------------------------------------------------------------------------------
+
+cVector3d cComputeCapsuleContactForces(const double* a_x,
+    const double* a_y,
+    const double* a_z,
+    int a_count,
+    const cVector3d& a_end0,
+    const cVector3d& a_end1,
+    double a_contactRadius,
+    double a_stiffness,
+    double* a_fx,
+    double* a_fy,
+    double* a_fz)
+{
+    cVector3d axis = a_end1 - a_end0;
+    double length2 = axis.lengthsq();
+    double invLength2 = (length2 > 0.0) ? 1.0 / length2 : 0.0;
+
+#if defined(C_CONTACT_USE_AVX)
+
+    const __m256d ex = _mm256_set1_pd(a_end0(0));
+    const __m256d ey = _mm256_set1_pd(a_end0(1));
+    const __m256d ez = _mm256_set1_pd(a_end0(2));
+    const __m256d ax = _mm256_set1_pd(axis(0));
+    const __m256d ay = _mm256_set1_pd(axis(1));
+    const __m256d az = _mm256_set1_pd(axis(2));
+    const __m256d invLength = _mm256_set1_pd(invLength2);
+    const __m256d radius = _mm256_set1_pd(a_contactRadius);
+    const __m256d stiffness = _mm256_set1_pd(a_stiffness);
+    const __m256d minDistance = _mm256_set1_pd(C_CONTACT_MIN_DISTANCE);
+    const __m256d zero = _mm256_setzero_pd();
+    const __m256d one = _mm256_set1_pd(1.0);
+
+    __m256d sx = zero, sy = zero, sz = zero;
+
+    int i = 0;
+    for (; i + 4 <= a_count; i += 4)
+    {
+        __m256d x = _mm256_loadu_pd(a_x + i);
+        __m256d y = _mm256_loadu_pd(a_y + i);
+        __m256d z = _mm256_loadu_pd(a_z + i);
+
+        // closest point of the segment
+        __m256d px = _mm256_sub_pd(x, ex);
+        __m256d py = _mm256_sub_pd(y, ey);
+        __m256d pz = _mm256_sub_pd(z, ez);
+        __m256d t = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(px, ax), _mm256_mul_pd(py, ay)), _mm256_mul_pd(pz, az));
+        t = _mm256_min_pd(_mm256_max_pd(_mm256_mul_pd(t, invLength), zero), one);
+
+        __m256d dx = _mm256_sub_pd(_mm256_add_pd(ex, _mm256_mul_pd(t, ax)), x);
+        __m256d dy = _mm256_sub_pd(_mm256_add_pd(ey, _mm256_mul_pd(t, ay)), y);
+        __m256d dz = _mm256_sub_pd(_mm256_add_pd(ez, _mm256_mul_pd(t, az)), z);
+        __m256d d2 = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy)), _mm256_mul_pd(dz, dz));
+        __m256d d = _mm256_sqrt_pd(d2);
+
+        __m256d mask = _mm256_and_pd(_mm256_cmp_pd(d, minDistance, _CMP_GE_OQ), _mm256_cmp_pd(d, radius, _CMP_LE_OQ));
+        __m256d s = _mm256_div_pd(_mm256_mul_pd(_mm256_sub_pd(radius, d), stiffness), d);
+        s = _mm256_and_pd(s, mask);
+
+        __m256d fx = _mm256_mul_pd(dx, s);
+        __m256d fy = _mm256_mul_pd(dy, s);
+        __m256d fz = _mm256_mul_pd(dz, s);
+
+        _mm256_storeu_pd(a_fx + i, _mm256_sub_pd(zero, fx));
+        _mm256_storeu_pd(a_fy + i, _mm256_sub_pd(zero, fy));
+        _mm256_storeu_pd(a_fz + i, _mm256_sub_pd(zero, fz));
+
+        sx = _mm256_add_pd(sx, fx);
+        sy = _mm256_add_pd(sy, fy);
+        sz = _mm256_add_pd(sz, fz);
+    }
+
+    double sum[3][C_CONTACT_LANES];
+    _mm256_storeu_pd(sum[0], sx);
+    _mm256_storeu_pd(sum[1], sy);
+    _mm256_storeu_pd(sum[2], sz);
+
+#elif defined(C_CONTACT_USE_SSE2)
+
+    const __m128d ex = _mm_set1_pd(a_end0(0));
+    const __m128d ey = _mm_set1_pd(a_end0(1));
+    const __m128d ez = _mm_set1_pd(a_end0(2));
+    const __m128d ax = _mm_set1_pd(axis(0));
+    const __m128d ay = _mm_set1_pd(axis(1));
+    const __m128d az = _mm_set1_pd(axis(2));
+    const __m128d invLength = _mm_set1_pd(invLength2);
+    const __m128d radius = _mm_set1_pd(a_contactRadius);
+    const __m128d stiffness = _mm_set1_pd(a_stiffness);
+    const __m128d minDistance = _mm_set1_pd(C_CONTACT_MIN_DISTANCE);
+    const __m128d zero = _mm_setzero_pd();
+    const __m128d one = _mm_set1_pd(1.0);
+
+    // lanes 0-1 and 2-3 of each group of four nodes
+    __m128d sx[2] = { zero, zero }, sy[2] = { zero, zero }, sz[2] = { zero, zero };
+
+    int i = 0;
+    for (; i + 4 <= a_count; i += 4)
+    {
+        for (int h = 0; h < 2; h++)
+        {
+            int k = i + 2 * h;
+            __m128d x = _mm_loadu_pd(a_x + k);
+            __m128d y = _mm_loadu_pd(a_y + k);
+            __m128d z = _mm_loadu_pd(a_z + k);
+
+            // closest point of the segment
+            __m128d px = _mm_sub_pd(x, ex);
+            __m128d py = _mm_sub_pd(y, ey);
+            __m128d pz = _mm_sub_pd(z, ez);
+            __m128d t = _mm_add_pd(_mm_add_pd(_mm_mul_pd(px, ax), _mm_mul_pd(py, ay)), _mm_mul_pd(pz, az));
+            t = _mm_min_pd(_mm_max_pd(_mm_mul_pd(t, invLength), zero), one);
+
+            __m128d dx = _mm_sub_pd(_mm_add_pd(ex, _mm_mul_pd(t, ax)), x);
+            __m128d dy = _mm_sub_pd(_mm_add_pd(ey, _mm_mul_pd(t, ay)), y);
+            __m128d dz = _mm_sub_pd(_mm_add_pd(ez, _mm_mul_pd(t, az)), z);
+            __m128d d2 = _mm_add_pd(_mm_add_pd(_mm_mul_pd(dx, dx), _mm_mul_pd(dy, dy)), _mm_mul_pd(dz, dz));
+            __m128d d = _mm_sqrt_pd(d2);
+
+            __m128d mask = _mm_and_pd(_mm_cmpge_pd(d, minDistance), _mm_cmple_pd(d, radius));
+            __m128d s = _mm_div_pd(_mm_mul_pd(_mm_sub_pd(radius, d), stiffness), d);
+            s = _mm_and_pd(s, mask);
+
+            __m128d fx = _mm_mul_pd(dx, s);
+            __m128d fy = _mm_mul_pd(dy, s);
+            __m128d fz = _mm_mul_pd(dz, s);
+
+            _mm_storeu_pd(a_fx + k, _mm_sub_pd(zero, fx));
+            _mm_storeu_pd(a_fy + k, _mm_sub_pd(zero, fy));
+            _mm_storeu_pd(a_fz + k, _mm_sub_pd(zero, fz));
+
+            sx[h] = _mm_add_pd(sx[h], fx);
+            sy[h] = _mm_add_pd(sy[h], fy);
+            sz[h] = _mm_add_pd(sz[h], fz);
+        }
+    }
+
+    double sum[3][C_CONTACT_LANES];
+    _mm_storeu_pd(sum[0] + 0, sx[0]); _mm_storeu_pd(sum[0] + 2, sx[1]);
+    _mm_storeu_pd(sum[1] + 0, sy[0]); _mm_storeu_pd(sum[1] + 2, sy[1]);
+    _mm_storeu_pd(sum[2] + 0, sz[0]); _mm_storeu_pd(sum[2] + 2, sz[1]);
+
+#else
+
+    double sum[3][C_CONTACT_LANES] = { { 0.0 } };
+    int i = 0;
+
+#endif
+
+    // remaining nodes
+    for (; i < a_count; i++)
+    {
+        capsuleNode(i, a_x, a_y, a_z, a_end0, axis, invLength2, a_contactRadius, a_stiffness, a_fx, a_fy, a_fz, sum);
+    }
+
+    return (reduceLanes(sum));
+}
+
+//------------------------------------------------------------------------------
+
+cVector3d cComputeBoxContactForces(const double* a_x,
+    const double* a_y,
+    const double* a_z,
+    int a_count,
+    const cVector3d& a_center,
+    const cMatrix3d& a_rot,
+    const cVector3d& a_halfSize,
+    double a_contactRadius,
+    double a_stiffness,
+    double* a_fx,
+    double* a_fy,
+    double* a_fz)
+{
+    double sum[3][C_CONTACT_LANES] = { { 0.0 } };
+    for (int i = 0; i < a_count; i++)
+    {
+        // node in the box frame
+        cVector3d p(a_x[i] - a_center(0), a_y[i] - a_center(1), a_z[i] - a_center(2));
+        double q[3];
+        for (int k = 0; k < 3; k++)
+        {
+            q[k] = a_rot(0, k) * p(0) + a_rot(1, k) * p(1) + a_rot(2, k) * p(2);
+        }
+
+        // offset to the closest point of the box
+        cVector3d delta;
+        for (int k = 0; k < 3; k++)
+        {
+            delta(k) = cClamp(q[k], -a_halfSize(k), a_halfSize(k)) - q[k];
+        }
+
+        if (delta.lengthsq() >= C_CONTACT_MIN_DISTANCE * C_CONTACT_MIN_DISTANCE)
+        {
+            // outside the box, same penalty as around a point
+            cVector3d d = a_rot * delta;
+            penaltyNode(i, d(0), d(1), d(2), a_contactRadius, a_stiffness, a_fx, a_fy, a_fz, sum);
+            continue;
+        }
+
+        // inside the box, push the node out through the nearest face
+        int axis = 0;
+        for (int k = 1; k < 3; k++)
+        {
+            if (a_halfSize(k) - fabs(q[k]) < a_halfSize(axis) - fabs(q[axis]))
+            {
+                axis = k;
+            }
+        }
+        double depth = a_halfSize(axis) - fabs(q[axis]) + a_contactRadius;
+        double s = ((q[axis] < 0.0) ? -depth : depth) * a_stiffness;
+        cVector3d f(-s * a_rot(0, axis), -s * a_rot(1, axis), -s * a_rot(2, axis));
+
+        a_fx[i] = 0.0 - f(0);
+        a_fy[i] = 0.0 - f(1);
+        a_fz[i] = 0.0 - f(2);
+
+        int lane = i % C_CONTACT_LANES;
+        sum[0][lane] += f(0);
+        sum[1][lane] += f(1);
+        sum[2][lane] += f(2);
+    }
+    return (reduceLanes(sum));
+}
+
+//------------------------------------------------------------------------------
+
+cVector3d cComputeCapsuleContactForces(cContactBatch& a_batch,
+    const cVector3d& a_end0,
+    const cVector3d& a_end1,
+    double a_contactRadius,
+    double a_stiffness)
+{
+    if (a_batch.m_count == 0)
+    {
+        return (cVector3d(0.0, 0.0, 0.0));
+    }
+
+    return (cComputeCapsuleContactForces(&a_batch.m_x[0], &a_batch.m_y[0], &a_batch.m_z[0], a_batch.m_count,
+        a_end0, a_end1, a_contactRadius, a_stiffness,
+        &a_batch.m_fx[0], &a_batch.m_fy[0], &a_batch.m_fz[0]));
+}
+
+//------------------------------------------------------------------------------
+
+cVector3d cComputeBoxContactForces(cContactBatch& a_batch,
+    const cVector3d& a_center,
+    const cMatrix3d& a_rot,
+    const cVector3d& a_halfSize,
+    double a_contactRadius,
+    double a_stiffness)
+{
+    if (a_batch.m_count == 0)
+    {
+        return (cVector3d(0.0, 0.0, 0.0));
+    }
+
+    return (cComputeBoxContactForces(&a_batch.m_x[0], &a_batch.m_y[0], &a_batch.m_z[0], a_batch.m_count,
+        a_center, a_rot, a_halfSize, a_contactRadius, a_stiffness,
+        &a_batch.m_fx[0], &a_batch.m_fy[0], &a_batch.m_fz[0]));
+}
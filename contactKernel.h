@@ -0,0 +1,135 @@
+#pragma once
+
+#include "chai3d.h"
+
+#include <vector>
+
+//------------------------------------------------------------------------------
+// DECLARED MACROS
+//------------------------------------------------------------------------------
+
+// number of nodes processed together by the contact kernel. the scalar path
+// accumulates in the same lanes, so that both paths return identical forces.
+#define C_CONTACT_LANES 4
+
+// define C_CONTACT_USE_SCALAR to disable the SSE2/AVX code paths
+#if !defined(C_CONTACT_USE_SCALAR)
+#if defined(__AVX__)
+#define C_CONTACT_USE_AVX
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define C_CONTACT_USE_SSE2
+#endif
+#endif
+
+//------------------------------------------------------------------------------
+// DECLARED TYPES
+//------------------------------------------------------------------------------
+
+// node positions and contact forces stored as contiguous x/y/z arrays
+struct cContactBatch
+{
+    // resize the batch to hold a_count nodes
+    void resize(int a_count);
+
+    // number of nodes in the batch
+    int m_count;
+
+    // node indices, positions and forces applied on the nodes
+    std::vector<int> m_index;
+    std::vector<double> m_x, m_y, m_z;
+    std::vector<double> m_fx, m_fy, m_fz;
+};
+
+//------------------------------------------------------------------------------
+// DECLARED FUNCTIONS
+//------------------------------------------------------------------------------
+
+// compute sphere-node penalty forces for a_count nodes. the force applied on
+// each node is written to a_fx/a_fy/a_fz, the force on the tool is returned.
+chai3d::cVector3d cComputeContactForces(const double* a_x,
+    const double* a_y,
+    const double* a_z,
+    int a_count,
+    const chai3d::cVector3d& a_cursor,
+    double a_contactRadius,
+    double a_stiffness,
+    double* a_fx,
+    double* a_fy,
+    double* a_fz);
+
+// scalar reference implementation of cComputeContactForces()
+chai3d::cVector3d cComputeContactForcesScalar(const double* a_x,
+    const double* a_y,
+    const double* a_z,
+    int a_count,
+    const chai3d::cVector3d& a_cursor,
+    double a_contactRadius,
+    double a_stiffness,
+    double* a_fx,
+    double* a_fy,
+    double* a_fz);
+
+// compute contact forces for all nodes of a batch
+chai3d::cVector3d cComputeContactForces(cContactBatch& a_batch,
+    const chai3d::cVector3d& a_cursor,
+    double a_contactRadius,
+    double a_stiffness);
+
+// compute capsule-node penalty forces for a_count nodes, the capsule is the
+// segment [a_end0, a_end1] grown by a_contactRadius. with equal ends it gives
+// the same forces as the sphere kernel.
+chai3d::cVector3d cComputeCapsuleContactForces(const double* a_x,
+    const double* a_y,
+    const double* a_z,
+    int a_count,
+    const chai3d::cVector3d& a_end0,
+    const chai3d::cVector3d& a_end1,
+    double a_contactRadius,
+    double a_stiffness,
+    double* a_fx,
+    double* a_fy,
+    double* a_fz);
+
+// scalar reference implementation of cComputeCapsuleContactForces()
+chai3d::cVector3d cComputeCapsuleContactForcesScalar(const double* a_x,
+    const double* a_y,
+    const double* a_z,
+    int a_count,
+    const chai3d::cVector3d& a_end0,
+    const chai3d::cVector3d& a_end1,
+    double a_contactRadius,
+    double a_stiffness,
+    double* a_fx,
+    double* a_fy,
+    double* a_fz);
+
+// compute box-node penalty forces for a_count nodes, the box has axes a_rot
+// and half sizes a_halfSize around a_center, grown by a_contactRadius. nodes
+// inside the box are pushed out through the nearest face.
+chai3d::cVector3d cComputeBoxContactForces(const double* a_x,
+    const double* a_y,
+    const double* a_z,
+    int a_count,
+    const chai3d::cVector3d& a_center,
+    const chai3d::cMatrix3d& a_rot,
+    const chai3d::cVector3d& a_halfSize,
+    double a_contactRadius,
+    double a_stiffness,
+    double* a_fx,
+    double* a_fy,
+    double* a_fz);
+
+// compute capsule contact forces for all nodes of a batch
+chai3d::cVector3d cComputeCapsuleContactForces(cContactBatch& a_batch,
+    const chai3d::cVector3d& a_end0,
+    const chai3d::cVector3d& a_end1,
+    double a_contactRadius,
+    double a_stiffness);
+
+// compute box contact forces for all nodes of a batch
+chai3d::cVector3d cComputeBoxContactForces(cContactBatch& a_batch,
+    const chai3d::cVector3d& a_center,
+    const chai3d::cMatrix3d& a_rot,
+    const chai3d::cVector3d& a_halfSize,
+    double a_contactRadius,
+    double a_stiffness);
@@ -0,0 +1,24 @@
+//------------------------------------------------------------------------------
+#include "contactProxy.h"
+//------------------------------------------------------------------------------
+using namespace chai3d;
+//------------------------------------------------------------------------------
+
+void cUpdateContactProxy(cContactProxy& a_proxy,
+    const cVector3d& a_toolPos,
+    const cVector3d& a_force,
+    double a_stiffness)
+{
+    double magnitude = a_force.length();
+    if ((magnitude <= 0.0) || (a_stiffness <= 0.0))
+    {
+        a_proxy.m_active = false;
+        return;
+    }
+
+    // plane through the point where the penalty force would vanish
+    a_proxy.m_active = true;
+    a_proxy.m_normal = a_force / magnitude;
+    a_proxy.m_stiffness = a_stiffness;
+    a_proxy.m_offset = a_proxy.m_normal.dot(a_toolPos) + magnitude / a_stiffness;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "chai3d.h"
+
+//------------------------------------------------------------------------------
+// DECLARED TYPES
+//------------------------------------------------------------------------------
+
+// local contact model refreshed by the physics thread and evaluated by the
+// haptics thread at its own rate: a plane with normal m_normal and offset
+// m_offset that pushes the tool back with stiffness m_stiffness
+struct cContactProxy
+{
+    // true if the tool touched the cloth at the last physics step
+    bool m_active;
+
+    // plane normal (direction of the force on the tool)
+    chai3d::cVector3d m_normal;
+
+    // plane offset along the normal [m]
+    double m_offset;
+
+    // contact stiffness [N/m]
+    double m_stiffness;
+
+    // physics step at which the proxy was built
+    unsigned long long m_tick;
+};
+
+//------------------------------------------------------------------------------
+// DECLARED FUNCTIONS
+//------------------------------------------------------------------------------
+
+// build a proxy that returns a_force for a tool at a_toolPos and stiffens
+// with a_stiffness around it
+void cUpdateContactProxy(cContactProxy& a_proxy,
+    const chai3d::cVector3d& a_toolPos,
+    const chai3d::cVector3d& a_force,
+    double a_stiffness);
+
+// force on a tool at a_toolPos
+inline chai3d::cVector3d cComputeProxyForce(const cContactProxy& a_proxy, const chai3d::cVector3d& a_toolPos)
+{
+    if (!a_proxy.m_active)
+    {
+        return (chai3d::cVector3d(0.0, 0.0, 0.0));
+    }
+
+    double penetration = a_proxy.m_offset - a_proxy.m_normal.dot(a_toolPos);
+    if (penetration <= 0.0)
+    {
+        return (chai3d::cVector3d(0.0, 0.0, 0.0));
+    }
+
+    return ((a_proxy.m_stiffness * penetration) * a_proxy.m_normal);
+}
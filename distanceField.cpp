@@ -0,0 +1,356 @@
+//------------------------------------------------------------------------------
+#include "distanceField.h"
+//------------------------------------------------------------------------------
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <utility>
+//------------------------------------------------------------------------------
+using namespace chai3d;
+//------------------------------------------------------------------------------
+
+cDistanceField::cDistanceField()
+{
+    m_cellSize = 1.0;
+    m_size[0] = m_size[1] = m_size[2] = 0;
+}
+
+//------------------------------------------------------------------------------
+
+cVector3d cDistanceField::getBoundaryMax() const
+{
+    return (m_min + m_cellSize * cVector3d(m_size[0] - 1, m_size[1] - 1, m_size[2] - 1));
+}
+
+//------------------------------------------------------------------------------
+
+bool cDistanceField::build(cMesh* a_mesh, double a_cellSize, double a_padding)
+{
+    m_vertices.clear();
+    m_triangles.clear();
+    m_faceNormals.clear();
+    m_distance.clear();
+    m_size[0] = m_size[1] = m_size[2] = 0;
+
+    // weld vertices at the same position, meshes often split them along
+    // sharp edges or texture seams and the pseudo-normals need the topology
+    std::map<std::pair<std::pair<double, double>, double>, int> welded;
+    std::vector<int> remap(a_mesh->getNumVertices());
+    for (unsigned int i = 0; i < a_mesh->getNumVertices(); i++)
+    {
+        cVector3d pos = a_mesh->m_vertices->getLocalPos(i);
+        std::pair<std::pair<double, double>, double> key(std::make_pair(pos(0), pos(1)), pos(2));
+        std::map<std::pair<std::pair<double, double>, double>, int>::iterator it = welded.find(key);
+        if (it == welded.end())
+        {
+            it = welded.insert(std::make_pair(key, (int)m_vertices.size())).first;
+            m_vertices.push_back(pos);
+        }
+        remap[i] = it->second;
+    }
+
+    // non degenerate triangles and their normals
+    for (unsigned int i = 0; i < a_mesh->getNumTriangles(); i++)
+    {
+        int a = remap[a_mesh->m_triangles->getVertexIndex0(i)];
+        int b = remap[a_mesh->m_triangles->getVertexIndex1(i)];
+        int c = remap[a_mesh->m_triangles->getVertexIndex2(i)];
+        cVector3d normal = cCross(m_vertices[b] - m_vertices[a], m_vertices[c] - m_vertices[a]);
+        if (normal.length() < 1e-18)
+        {
+            continue;
+        }
+        m_triangles.push_back(a);
+        m_triangles.push_back(b);
+        m_triangles.push_back(c);
+        m_faceNormals.push_back(cNormalize(normal));
+    }
+    int numTriangles = (int)(m_triangles.size() / 3);
+    if (numTriangles == 0)
+    {
+        return (false);
+    }
+
+    // vertex normals weighted by the corner angles, edge normals summed
+    // over the faces sharing the edge
+    m_vertexNormals.assign(m_vertices.size(), cVector3d(0.0, 0.0, 0.0));
+    std::map<std::pair<int, int>, cVector3d> edgeSums;
+    for (int t = 0; t < numTriangles; t++)
+    {
+        const cVector3d& normal = m_faceNormals[t];
+        for (int k = 0; k < 3; k++)
+        {
+            int v0 = m_triangles[3 * t + k];
+            int v1 = m_triangles[3 * t + (k + 1) % 3];
+            int v2 = m_triangles[3 * t + (k + 2) % 3];
+            cVector3d e1 = cNormalize(m_vertices[v1] - m_vertices[v0]);
+            cVector3d e2 = cNormalize(m_vertices[v2] - m_vertices[v0]);
+            double angle = acos(cClamp(cDot(e1, e2), -1.0, 1.0));
+            m_vertexNormals[v0] += angle * normal;
+            edgeSums[std::make_pair(std::min(v0, v1), std::max(v0, v1))] += normal;
+        }
+    }
+    m_edgeNormals.resize(3 * numTriangles);
+    for (int t = 0; t < numTriangles; t++)
+    {
+        for (int k = 0; k < 3; k++)
+        {
+            int v0 = m_triangles[3 * t + k];
+            int v1 = m_triangles[3 * t + (k + 1) % 3];
+            m_edgeNormals[3 * t + k] = edgeSums[std::make_pair(std::min(v0, v1), std::max(v0, v1))];
+        }
+    }
+
+    // grid over the padded box
+    cVector3d lower = m_vertices[0];
+    cVector3d upper = m_vertices[0];
+    for (size_t i = 1; i < m_vertices.size(); i++)
+    {
+        for (int k = 0; k < 3; k++)
+        {
+            lower(k) = std::min(lower(k), m_vertices[i](k));
+            upper(k) = std::max(upper(k), m_vertices[i](k));
+        }
+    }
+    m_cellSize = a_cellSize;
+    m_min = lower - cVector3d(a_padding, a_padding, a_padding);
+    for (int k = 0; k < 3; k++)
+    {
+        m_size[k] = (int)ceil((upper(k) - lower(k) + 2.0 * a_padding) / a_cellSize) + 1;
+    }
+    int numPoints = m_size[0] * m_size[1] * m_size[2];
+    m_distance.assign(numPoints, 1e30);
+    std::vector<int> closest(numPoints, -1);
+
+    // exact distances within a cell of each triangle
+    cVector3d point;
+    int feature;
+    for (int t = 0; t < numTriangles; t++)
+    {
+        int range[3][2];
+        for (int k = 0; k < 3; k++)
+        {
+            double lo = std::min(m_vertices[m_triangles[3 * t]](k), std::min(m_vertices[m_triangles[3 * t + 1]](k), m_vertices[m_triangles[3 * t + 2]](k)));
+            double hi = std::max(m_vertices[m_triangles[3 * t]](k), std::max(m_vertices[m_triangles[3 * t + 1]](k), m_vertices[m_triangles[3 * t + 2]](k)));
+            range[k][0] = std::max(0, (int)floor((lo - m_min(k)) / m_cellSize) - 1);
+            range[k][1] = std::min(m_size[k] - 1, (int)ceil((hi - m_min(k)) / m_cellSize) + 1);
+        }
+        for (int kz = range[2][0]; kz <= range[2][1]; kz++)
+        {
+            for (int jy = range[1][0]; jy <= range[1][1]; jy++)
+            {
+                for (int ix = range[0][0]; ix <= range[0][1]; ix++)
+                {
+                    cVector3d pos = m_min + m_cellSize * cVector3d(ix, jy, kz);
+                    double distance = distanceToTriangle(pos, t, point, feature);
+                    int n = index(ix, jy, kz);
+                    if (distance < m_distance[n])
+                    {
+                        m_distance[n] = distance;
+                        closest[n] = t;
+                    }
+                }
+            }
+        }
+    }
+
+    // sweep the grid in all eight diagonal directions, twice, taking the
+    // closest triangle of the already visited neighbours when it is closer
+    for (int pass = 0; pass < 2; pass++)
+    {
+        for (int dir = 0; dir < 8; dir++)
+        {
+            int di = (dir & 1) ? -1 : 1;
+            int dj = (dir & 2) ? -1 : 1;
+            int dk = (dir & 4) ? -1 : 1;
+            for (int kz = (dk > 0) ? 0 : m_size[2] - 1; (kz >= 0) && (kz < m_size[2]); kz += dk)
+            {
+                for (int jy = (dj > 0) ? 0 : m_size[1] - 1; (jy >= 0) && (jy < m_size[1]); jy += dj)
+                {
+                    for (int ix = (di > 0) ? 0 : m_size[0] - 1; (ix >= 0) && (ix < m_size[0]); ix += di)
+                    {
+                        int n = index(ix, jy, kz);
+                        cVector3d pos = m_min + m_cellSize * cVector3d(ix, jy, kz);
+                        for (int m = 1; m < 8; m++)
+                        {
+                            int ni = ix - ((m & 1) ? di : 0);
+                            int nj = jy - ((m & 2) ? dj : 0);
+                            int nk = kz - ((m & 4) ? dk : 0);
+                            if ((ni < 0) || (ni >= m_size[0]) || (nj < 0) || (nj >= m_size[1]) || (nk < 0) || (nk >= m_size[2]))
+                            {
+                                continue;
+                            }
+                            int t = closest[index(ni, nj, nk)];
+                            if ((t < 0) || (t == closest[n]))
+                            {
+                                continue;
+                            }
+                            double distance = distanceToTriangle(pos, t, point, feature);
+                            if (distance < m_distance[n])
+                            {
+                                m_distance[n] = distance;
+                                closest[n] = t;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    // sign from the pseudo-normal of the closest feature
+    for (int kz = 0; kz < m_size[2]; kz++)
+    {
+        for (int jy = 0; jy < m_size[1]; jy++)
+        {
+            for (int ix = 0; ix < m_size[0]; ix++)
+            {
+                int n = index(ix, jy, kz);
+                int t = closest[n];
+                cVector3d pos = m_min + m_cellSize * cVector3d(ix, jy, kz);
+                distanceToTriangle(pos, t, point, feature);
+                cVector3d normal;
+                if (feature == 0)
+                {
+                    normal = m_faceNormals[t];
+                }
+                else if (feature <= 3)
+                {
+                    normal = m_edgeNormals[3 * t + feature - 1];
+                }
+                else
+                {
+                    normal = m_vertexNormals[m_triangles[3 * t + feature - 4]];
+                }
+                if (cDot(pos - point, normal) < 0.0)
+                {
+                    m_distance[n] = -m_distance[n];
+                }
+            }
+        }
+    }
+
+    return (true);
+}
+
+//------------------------------------------------------------------------------
+
+double cDistanceField::distanceToTriangle(const cVector3d& a_pos, int a_triangle,
+                                          cVector3d& a_closest, int& a_feature) const
+{
+    // regions of the closest point, after Ericson, Real-Time Collision Detection
+    const cVector3d& a = m_vertices[m_triangles[3 * a_triangle + 0]];
+    const cVector3d& b = m_vertices[m_triangles[3 * a_triangle + 1]];
+    const cVector3d& c = m_vertices[m_triangles[3 * a_triangle + 2]];
+    cVector3d ab = b - a;
+    cVector3d ac = c - a;
+
+    cVector3d ap = a_pos - a;
+    double d1 = cDot(ab, ap);
+    double d2 = cDot(ac, ap);
+    if ((d1 <= 0.0) && (d2 <= 0.0))
+    {
+        a_closest = a;
+        a_feature = 4;
+        return (ap.length());
+    }
+
+    cVector3d bp = a_pos - b;
+    double d3 = cDot(ab, bp);
+    double d4 = cDot(ac, bp);
+    if ((d3 >= 0.0) && (d4 <= d3))
+    {
+        a_closest = b;
+        a_feature = 5;
+        return (bp.length());
+    }
+
+    double vc = d1 * d4 - d3 * d2;
+    if ((vc <= 0.0) && (d1 >= 0.0) && (d3 <= 0.0))
+    {
+        a_closest = a + (d1 / (d1 - d3)) * ab;
+        a_feature = 1;
+        return (a_pos.distance(a_closest));
+    }
+
+    cVector3d cp = a_pos - c;
+    double d5 = cDot(ab, cp);
+    double d6 = cDot(ac, cp);
+    if ((d6 >= 0.0) && (d5 <= d6))
+    {
+        a_closest = c;
+        a_feature = 6;
+        return (cp.length());
+    }
+
+    double vb = d5 * d2 - d1 * d6;
+    if ((vb <= 0.0) && (d2 >= 0.0) && (d6 <= 0.0))
+    {
+        a_closest = a + (d2 / (d2 - d6)) * ac;
+        a_feature = 3;
+        return (a_pos.distance(a_closest));
+    }
+
+    double va = d3 * d6 - d5 * d4;
+    if ((va <= 0.0) && (d4 - d3 >= 0.0) && (d5 - d6 >= 0.0))
+    {
+        a_closest = b + ((d4 - d3) / ((d4 - d3) + (d5 - d6))) * (c - b);
+        a_feature = 2;
+        return (a_pos.distance(a_closest));
+    }
+
+    double denom = 1.0 / (va + vb + vc);
+    a_closest = a + (vb * denom) * ab + (vc * denom) * ac;
+    a_feature = 0;
+    return (a_pos.distance(a_closest));
+}
+
+//------------------------------------------------------------------------------
+
+double cDistanceField::sample(const cVector3d& a_pos, cVector3d& a_gradient, double a_outside) const
+{
+    a_gradient.zero();
+    if (m_distance.empty())
+    {
+        return (a_outside);
+    }
+
+    // cell and position within the cell
+    double g[3];
+    int c[3];
+    for (int k = 0; k < 3; k++)
+    {
+        g[k] = (a_pos(k) - m_min(k)) / m_cellSize;
+        if ((g[k] < 0.0) || (g[k] > (double)(m_size[k] - 1)))
+        {
+            return (a_outside);
+        }
+        c[k] = std::min((int)g[k], m_size[k] - 2);
+        g[k] -= c[k];
+    }
+
+    const double* d = &m_distance[0];
+    int n = index(c[0], c[1], c[2]);
+    int sx = 1;
+    int sy = m_size[0];
+    int sz = m_size[0] * m_size[1];
+    double d000 = d[n], d100 = d[n + sx], d010 = d[n + sy], d110 = d[n + sx + sy];
+    double d001 = d[n + sz], d101 = d[n + sx + sz], d011 = d[n + sy + sz], d111 = d[n + sx + sy + sz];
+
+    // trilinear interpolation and its derivatives
+    double fx = g[0], fy = g[1], fz = g[2];
+    double d00 = d000 + fx * (d100 - d000);
+    double d10 = d010 + fx * (d110 - d010);
+    double d01 = d001 + fx * (d101 - d001);
+    double d11 = d011 + fx * (d111 - d011);
+    double d0 = d00 + fy * (d10 - d00);
+    double d1 = d01 + fy * (d11 - d01);
+
+    double gx = (1.0 - fy) * (1.0 - fz) * (d100 - d000) + fy * (1.0 - fz) * (d110 - d010) +
+                (1.0 - fy) * fz * (d101 - d001) + fy * fz * (d111 - d011);
+    double gy = (1.0 - fz) * (d10 - d00) + fz * (d11 - d01);
+    double gz = d1 - d0;
+    a_gradient.set(gx / m_cellSize, gy / m_cellSize, gz / m_cellSize);
+
+    return (d0 + fz * (d1 - d0));
+}
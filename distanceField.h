@@ -0,0 +1,68 @@
+#pragma once
+
+#include "chai3d.h"
+
+#include <vector>
+
+//------------------------------------------------------------------------------
+// DECLARED TYPES
+//------------------------------------------------------------------------------
+
+// signed distance to a mesh, sampled on a regular grid in the local frame of
+// the mesh and interpolated trilinearly. the grid is computed once: exact
+// distances in a band around every triangle, then fast sweeps that carry the
+// closest triangle to the rest of the grid. the sign comes from the angle
+// weighted pseudo-normal of the closest feature, which is negative inside a
+// closed mesh and behind the front faces of an open one.
+class cDistanceField
+{
+public:
+
+    // constructor
+    cDistanceField();
+
+    // sample the distance to a_mesh with cells of a_cellSize over its box
+    // padded by a_padding, returns false if the mesh has no triangle
+    bool build(chai3d::cMesh* a_mesh, double a_cellSize, double a_padding);
+
+    // distance at a_pos (local frame) and its gradient, positions outside
+    // the grid return a_outside with a zero gradient
+    double sample(const chai3d::cVector3d& a_pos, chai3d::cVector3d& a_gradient, double a_outside) const;
+
+    // grid box in the local frame
+    const chai3d::cVector3d& getBoundaryMin() const { return (m_min); }
+    chai3d::cVector3d getBoundaryMax() const;
+
+    // number of grid points along each axis
+    int getSize(int a_axis) const { return (m_size[a_axis]); }
+
+protected:
+
+    // unsigned distance from a_pos to triangle a_triangle, with the closest
+    // point and the feature it lies on (0: face, 1-3: edges, 4-6: vertices)
+    double distanceToTriangle(const chai3d::cVector3d& a_pos, int a_triangle,
+                              chai3d::cVector3d& a_closest, int& a_feature) const;
+
+    // grid point index
+    int index(int a_i, int a_j, int a_k) const { return ((a_k * m_size[1] + a_j) * m_size[0] + a_i); }
+
+protected:
+
+    // welded mesh: vertices, three vertices per triangle
+    std::vector<chai3d::cVector3d> m_vertices;
+    std::vector<int> m_triangles;
+
+    // pseudo-normals of the faces, of the three edges of each face and of
+    // the vertices
+    std::vector<chai3d::cVector3d> m_faceNormals;
+    std::vector<chai3d::cVector3d> m_edgeNormals;
+    std::vector<chai3d::cVector3d> m_vertexNormals;
+
+    // grid origin, cell size and number of points along each axis
+    chai3d::cVector3d m_min;
+    double m_cellSize;
+    int m_size[3];
+
+    // signed distance at each grid point [m]
+    std::vector<double> m_distance;
+};
@@ -0,0 +1,49 @@
+//------------------------------------------------------------------------------
+#include "fixedTimestep.h"
+//------------------------------------------------------------------------------
+#include <algorithm>
+//------------------------------------------------------------------------------
+
+cFixedTimestep::cFixedTimestep()
+{
+    setup(0.001, 1, 4);
+}
+
+//------------------------------------------------------------------------------
+
+void cFixedTimestep::setup(double a_step, int a_numSubsteps, int a_maxSteps)
+{
+    m_step = std::max(1e-6, a_step);
+    m_numSubsteps = std::max(1, a_numSubsteps);
+    m_maxSteps = std::max(1, a_maxSteps);
+    reset();
+}
+
+//------------------------------------------------------------------------------
+
+void cFixedTimestep::reset()
+{
+    m_accumulator = 0.0;
+    m_droppedTime = 0.0;
+}
+
+//------------------------------------------------------------------------------
+
+int cFixedTimestep::advance(double a_elapsed)
+{
+    m_accumulator += std::max(0.0, a_elapsed);
+
+    // whole steps, tolerating the rounding of intervals that are exact
+    // multiples of the step
+    int numSteps = (int)(m_accumulator / m_step + 1e-6);
+    m_accumulator = std::max(0.0, m_accumulator - numSteps * m_step);
+
+    // catch-up cap
+    if (numSteps > m_maxSteps)
+    {
+        m_droppedTime += (numSteps - m_maxSteps) * m_step;
+        numSteps = m_maxSteps;
+    }
+
+    return (numSteps);
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+//------------------------------------------------------------------------------
+// DECLARED TYPES
+//------------------------------------------------------------------------------
+
+// accumulator turning variable wall clock intervals into a whole number of
+// fixed physics steps. time not yet simulated is carried over to the next
+// call, and the fraction of a step left over is used to interpolate between
+// the last two physics states. after a stall at most m_maxSteps steps are
+// run at once, the rest of the time is dropped so that the simulation slows
+// down instead of spiralling.
+class cFixedTimestep
+{
+public:
+
+    // constructor
+    cFixedTimestep();
+
+    // step length [s], substeps per step and catch-up cap
+    void setup(double a_step, int a_numSubsteps, int a_maxSteps);
+
+    // add a_elapsed seconds of wall clock time, returns the number of steps to run now
+    int advance(double a_elapsed);
+
+    // forget accumulated and dropped time
+    void reset();
+
+    // step length [s]
+    double getStep() const { return (m_step); }
+
+    // substep length [s]
+    double getSubstep() const { return (m_step / m_numSubsteps); }
+
+    // number of substeps per step
+    int getNumSubsteps() const { return (m_numSubsteps); }
+
+    // interpolation weight of the newest state, in [0, 1)
+    double getAlpha() const { return (m_accumulator / m_step); }
+
+    // wall clock time dropped by the catch-up cap [s]
+    double getDroppedTime() const { return (m_droppedTime); }
+
+protected:
+
+    // parameters
+    double m_step;
+    int m_numSubsteps;
+    int m_maxSteps;
+
+    // time not simulated yet [s]
+    double m_accumulator;
+
+    // time dropped by the catch-up cap [s]
+    double m_droppedTime;
+};
@@ -0,0 +1,132 @@
+//------------------------------------------------------------------------------
+#include "latencyHistogram.h"
+//------------------------------------------------------------------------------
+#include <cstdio>
+//------------------------------------------------------------------------------
+
+cLatencyHistogram::cLatencyHistogram(unsigned long long a_deadlineNs)
+{
+    m_deadline = a_deadlineNs;
+    reset();
+}
+
+//------------------------------------------------------------------------------
+
+void cLatencyHistogram::reset()
+{
+    for (int i = 0; i < C_NUM_BUCKETS; i++)
+    {
+        m_counts[i].store(0, std::memory_order_relaxed);
+    }
+    m_total.store(0, std::memory_order_relaxed);
+    m_numMisses.store(0, std::memory_order_relaxed);
+    m_max.store(0, std::memory_order_relaxed);
+}
+
+//------------------------------------------------------------------------------
+
+int cLatencyHistogram::bucketIndex(unsigned long long a_ns)
+{
+    if (a_ns < C_SUB_COUNT)
+    {
+        return ((int)a_ns);
+    }
+
+    // clamp long durations into the last bucket
+    const unsigned long long maxValue = (2ULL << C_MAX_BITS) - 1;
+    if (a_ns > maxValue)
+    {
+        a_ns = maxValue;
+    }
+
+    // position of the most significant bit
+    int msb = 0;
+    while ((a_ns >> (msb + 1)) != 0) { msb++; }
+
+    int shift = msb - C_SUB_BITS;
+    return ((shift + 1) * C_SUB_COUNT + (int)((a_ns >> shift) - C_SUB_COUNT));
+}
+
+//------------------------------------------------------------------------------
+
+unsigned long long cLatencyHistogram::bucketValue(int a_index)
+{
+    if (a_index < C_SUB_COUNT)
+    {
+        return ((unsigned long long)a_index);
+    }
+
+    int shift = a_index / C_SUB_COUNT - 1;
+    unsigned long long sub = (unsigned long long)(a_index % C_SUB_COUNT + C_SUB_COUNT);
+    return (sub << shift);
+}
+
+//------------------------------------------------------------------------------
+
+unsigned long long cLatencyHistogram::getPercentile(double a_p) const
+{
+    unsigned long long total = getCount();
+    if (total == 0)
+    {
+        return (0);
+    }
+
+    unsigned long long rank = (unsigned long long)(a_p * (double)total);
+    if (rank >= total) { rank = total - 1; }
+
+    unsigned long long count = 0;
+    for (int i = 0; i < C_NUM_BUCKETS; i++)
+    {
+        count += m_counts[i].load(std::memory_order_relaxed);
+        if (count > rank)
+        {
+            return (bucketValue(i));
+        }
+    }
+    return (getMax());
+}
+
+//------------------------------------------------------------------------------
+
+std::string cLatencyHistogram::getSummary() const
+{
+    char text[128];
+    snprintf(text, sizeof(text), "p50 %.1f  p99 %.1f  p99.9 %.1f  max %.1f us  misses %llu",
+        1e-3 * getPercentile(0.5), 1e-3 * getPercentile(0.99), 1e-3 * getPercentile(0.999),
+        1e-3 * getMax(), getNumMisses());
+    return (std::string(text));
+}
+
+//------------------------------------------------------------------------------
+
+cHapticTimings::cHapticTimings(unsigned long long a_deadlineNs)
+{
+    m_tickStart = 0;
+    m_last = 0;
+    m_marked = 0;
+
+    // only the whole tick and the tick interval have a deadline
+    for (int i = 0; i < C_NUM_HAPTIC_PHASES; i++)
+    {
+        bool timed = (i == C_PHASE_TICK) || (i == C_PHASE_INTERVAL);
+        m_histograms[i].setDeadline(timed ? a_deadlineNs : ~0ULL);
+        m_phaseNs[i] = 0;
+    }
+}
+
+//------------------------------------------------------------------------------
+
+const char* cHapticTimings::getPhaseName(int a_phase)
+{
+    static const char* names[C_NUM_HAPTIC_PHASES] =
+    {
+        "device read",
+        "contact",
+        "dynamics",
+        "set force",
+        "global positions",
+        "tick",
+        "interval"
+    };
+    return (names[a_phase]);
+}
@@ -0,0 +1,175 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <string>
+
+//------------------------------------------------------------------------------
+// DECLARED FUNCTIONS
+//------------------------------------------------------------------------------
+
+// monotonic timestamp [ns]
+inline unsigned long long cTimestampNs()
+{
+    return ((unsigned long long)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+//------------------------------------------------------------------------------
+// DECLARED TYPES
+//------------------------------------------------------------------------------
+
+// log-linear (HDR style) histogram of durations in nanoseconds. every power
+// of two is split in 32 buckets, which bounds the relative error to about 3%
+// from 32 ns up to about 2 s. one thread records, any thread can read.
+class cLatencyHistogram
+{
+public:
+
+    // number of linear buckets per power of two (log2)
+    enum { C_SUB_BITS = 5, C_SUB_COUNT = 1 << C_SUB_BITS };
+
+    // largest recorded power of two, longer durations are clamped
+    enum { C_MAX_BITS = 30, C_NUM_BUCKETS = (C_MAX_BITS - C_SUB_BITS + 2) * C_SUB_COUNT };
+
+    // constructor
+    cLatencyHistogram(unsigned long long a_deadlineNs = 1000000);
+
+    // record a duration (single writer)
+    void record(unsigned long long a_ns)
+    {
+        int i = bucketIndex(a_ns);
+        m_counts[i].store(m_counts[i].load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        m_total.store(m_total.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        if (a_ns > m_deadline)
+        {
+            m_numMisses.store(m_numMisses.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+        if (a_ns > m_max.load(std::memory_order_relaxed))
+        {
+            m_max.store(a_ns, std::memory_order_relaxed);
+        }
+    }
+
+    // duration below which a fraction a_p of the samples lie [ns]
+    unsigned long long getPercentile(double a_p) const;
+
+    // number of recorded samples
+    unsigned long long getCount() const { return m_total.load(std::memory_order_relaxed); }
+
+    // number of samples longer than the deadline
+    unsigned long long getNumMisses() const { return m_numMisses.load(std::memory_order_relaxed); }
+
+    // longest recorded duration [ns]
+    unsigned long long getMax() const { return m_max.load(std::memory_order_relaxed); }
+
+    // deadline used to count misses [ns]
+    unsigned long long getDeadline() const { return m_deadline; }
+    void setDeadline(unsigned long long a_deadlineNs) { m_deadline = a_deadlineNs; }
+
+    // one line summary with p50/p99/p99.9 in microseconds and the miss count
+    std::string getSummary() const;
+
+    // clear all samples (only while no sample is being recorded)
+    void reset();
+
+    // bucket of a duration
+    static int bucketIndex(unsigned long long a_ns);
+
+    // smallest duration of a bucket
+    static unsigned long long bucketValue(int a_index);
+
+protected:
+
+    // samples per bucket
+    std::atomic<unsigned int> m_counts[C_NUM_BUCKETS];
+
+    // number of samples, misses and longest sample
+    std::atomic<unsigned long long> m_total;
+    std::atomic<unsigned long long> m_numMisses;
+    std::atomic<unsigned long long> m_max;
+
+    // deadline [ns]
+    unsigned long long m_deadline;
+};
+
+//------------------------------------------------------------------------------
+
+// phases of a haptic tick
+enum cHapticPhase
+{
+    C_PHASE_DEVICE_READ = 0,
+    C_PHASE_CONTACT,
+    C_PHASE_DYNAMICS,
+    C_PHASE_SET_FORCE,
+    C_PHASE_GLOBAL_POSITIONS,
+    C_PHASE_TICK,
+    C_PHASE_INTERVAL,
+    C_NUM_HAPTIC_PHASES
+};
+
+// per phase latency histograms of the haptics thread
+class cHapticTimings
+{
+public:
+
+    // constructor, a_deadlineNs applies to the whole tick and to the tick interval
+    cHapticTimings(unsigned long long a_deadlineNs = 1000000);
+
+    // histogram of a phase
+    cLatencyHistogram& getHistogram(int a_phase) { return m_histograms[a_phase]; }
+    const cLatencyHistogram& getHistogram(int a_phase) const { return m_histograms[a_phase]; }
+
+    // display name of a phase
+    static const char* getPhaseName(int a_phase);
+
+    // start timing a new tick
+    void beginTick()
+    {
+        m_last = m_tickStart = cTimestampNs();
+        m_marked = 0;
+        for (int i = 0; i < C_NUM_HAPTIC_PHASES; i++)
+        {
+            m_phaseNs[i] = 0;
+        }
+    }
+
+    // add the time since the previous mark to a_phase, a phase marked several
+    // times in a tick (one per fixed step) is recorded once with the sum
+    void mark(int a_phase)
+    {
+        unsigned long long now = cTimestampNs();
+        m_phaseNs[a_phase] += now - m_last;
+        m_marked |= 1u << a_phase;
+        m_last = now;
+    }
+
+    // record a_phase for this tick even if it is never marked (zero time)
+    void include(int a_phase) { m_marked |= 1u << a_phase; }
+
+    // record the phases marked in this tick and the whole tick duration
+    void endTick()
+    {
+        for (int i = 0; i < C_NUM_HAPTIC_PHASES; i++)
+        {
+            if (m_marked & (1u << i))
+            {
+                m_histograms[i].record(m_phaseNs[i]);
+            }
+        }
+        m_histograms[C_PHASE_TICK].record(cTimestampNs() - m_tickStart);
+    }
+
+protected:
+
+    // histograms
+    cLatencyHistogram m_histograms[C_NUM_HAPTIC_PHASES];
+
+    // timestamps of the current tick
+    unsigned long long m_tickStart;
+    unsigned long long m_last;
+
+    // time of each phase in the current tick, and the phases marked
+    unsigned long long m_phaseNs[C_NUM_HAPTIC_PHASES];
+    unsigned int m_marked;
+};
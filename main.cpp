@@ -7,7 +7,29 @@
 
 //------------------------------------------------------------------------------
 #include "cloth.h"
+#include "clothContact.h"
+#include "clothXPBD.h"
+#include "clothImplicit.h"
+#include "clothSelfCollision.h"
+#include "clothMeshCollision.h"
+#include "threadPool.h"
+#include "tripleBuffer.h"
+#include "telemetry.h"
+#include "clothMesh.h"
+#include "clothSkin.h"
+#include "toolDevice.h"
+#include "virtualDevice.h"
+#include "sessionLog.h"
+#include "clothState.h"
+#include "clothPicking.h"
+#include "latencyHistogram.h"
+#include "contactProxy.h"
+#include "fixedTimestep.h"
 #include <GLFW/glfw3.h>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <thread>
 //------------------------------------------------------------------------------
 
 //------------------------------------------------------------------------------
@@ -31,6 +53,9 @@ cStereoMode stereoMode = C_STEREO_DISABLED;
 bool fullscreen = false;
 bool mirroredDisplay = false;
 
+// check for OpenGL errors after every frame
+bool glDebug = false;
+
 
 //------------------------------------------------------------------------------
 // DECLARED CHAI3D VARIABLES
@@ -53,20 +78,58 @@ cHapticDeviceHandler* handler;
 // a pointer to the current haptic device
 cGenericHapticDevicePtr hapticDevice;
 
+// devices driving a tool each on the shared cloth, the first one is hapticDevice
+int numDevices = 1;
+std::vector<cToolDevice*> toolDevices;
+
+// core of the haptics thread of the first device, device i runs on the next
+// i-th core (-1 for the last cores, -2 to leave the threads unpinned)
+int hapticCore = -1;
+
+// virtual device used in headless mode
+cScriptedHapticDevicePtr scriptedDevice;
+
+// run without window, OpenGL context and physical device
+bool headless = false;
+
+// simulated duration of a headless run [s]
+double headlessDuration = 10.0;
+
+// trajectory file of the virtual device (parametric trajectory if empty)
+string trajectoryFile;
+
+// log of the device positions and forces of every haptic tick
+cSessionRecorder sessionRecorder;
+string recordFile;
+
+// recorded session played back in place of a device
+cSessionReader replaySession;
+cReplayHapticDevicePtr replayDevice;
+string replayFile;
+
 cToolCursor* tool;
 
 // force scale factor
 double deviceForceScale;
 
-// scale factor between the device workspace and cursor workspace
-double workspaceScaleFactor;
-
 // desired workspace radius of the virtual cursor
 double cursorWorkspaceRadius;
 
 // a label to display the rate [Hz] at which the simulation is running
 cLabel* labelHapticRate;
 
+// labels to display the haptic tick latency of each phase
+cLabel* labelTimings[C_NUM_HAPTIC_PHASES];
+
+// labels to display the rate and latency of each device (several devices)
+std::vector<cLabel*> labelDevices;
+
+// show/hide the latency overlay
+bool showTimings = true;
+
+// per phase latency of the physics thread (multi-rate mode)
+cHapticTimings physicsTimings(1000000);
+
 // flag to indicate if the haptic simulation currently running
 bool simulationRunning = false;
 
@@ -76,11 +139,24 @@ bool simulationFinished = false;
 // a frequency counter to measure the simulation graphic rate
 cFrequencyCounter freqCounterGraphics;
 
-// a frequency counter to measure the simulation haptic rate
-cFrequencyCounter freqCounterHaptics;
+// haptics threads still running (multi-rate mode)
+std::atomic<int> numHapticsThreads(0);
+
+// run the cloth solver in its own thread, decoupled from the haptic rate
+bool multiRate = false;
+
+// rate of the haptic loop in multi-rate mode [Hz]
+double hapticRate = 1000.0;
+
+// cloth solver thread (multi-rate mode)
+cThread* physicsThread = NULL;
+
+// flag to indicate if the physics thread has terminated
+bool physicsFinished = true;
+
+// a frequency counter to measure the cloth solver rate (multi-rate mode)
+cFrequencyCounter freqCounterPhysics;
 
-// haptic thread
-cThread* hapticsThread;
 
 // a handle to window display context
 GLFWwindow* window = NULL;
@@ -114,14 +190,72 @@ cGELWorld* defWorld;
 // object mesh
 cMesh* tableObject;
 cMesh* clothObject;
+
+// obstacle resting on the table, NULL unless requested
+bool useObstacle = false;
+cMesh* obstacleObject = NULL;
+cClothRenderMesh clothMesh;
+
+// fine render mesh interpolated from the cloth nodes, used when the
+// refinement is above one, and the threads evaluating it
+int skinRefinement = 4;
+int numSkinThreads = 2;
+cClothSkin clothSkin;
+cThreadPool* skinPool = NULL;
 cGELMesh* defObject;
 
-// dynamic nodes
-cGELSkeletonNode* nodes[21][21];
+// cloth model (grid, skeleton nodes and render buffers)
+cClothModel* cloth;
+
+// cloth grid parameters
+cClothParams clothParams;
+
+// directory of settled cloth states, and the time to settle a new one [s]
+// (zero to run the simulation instead)
+string stateCacheDir;
+double settleTime = 0.0;
+
+// cloth dynamics engine, "gel", "xpbd" or "implicit"
+string solverType = "gel";
+cClothSolver* clothSolver = NULL;
+
+// advance the cloth in fixed steps taken from a wall clock accumulator
+bool fixedStepping = false;
+cFixedTimestep fixedStep;
+
+// tool force and torque of the last two fixed steps, interpolated for the device
+cVector3d previousForce(0.0, 0.0, 0.0);
+cVector3d currentForce(0.0, 0.0, 0.0);
+cVector3d previousTorque(0.0, 0.0, 0.0);
+cVector3d currentTorque(0.0, 0.0, 0.0);
+
+// threads solving the cloth constraints (XPBD solver only)
+int numSolverThreads = 1;
+cThreadPool* solverPool = NULL;
+
+// collision stage of the cloth against the table top
+cTableCollider tableCollider;
+
+// collision stage of the cloth against itself
+bool selfCollision = false;
+cSelfCollider selfCollider;
+
+// collision stage of the cloth against obstacle meshes
+cMeshCollider meshCollider;
+
+// cloth positions published by the haptics thread to the graphics thread
+cTripleBuffer<cClothSnapshot> clothSnapshot;
+
+// number of haptic ticks since the simulation started
+unsigned long long hapticTick = 0;
+
+// diagnostics recorded by the haptics thread
+cTelemetryLogger telemetry;
 
-// haptic device model
-cShapeSphere* device;
+// size and contact primitives of the tools
 double deviceRadius;
+string toolName = "sphere";
+cToolShape toolShape;
 
 // radius of the dynamic model sphere (GEM)
 double modelRadius;
@@ -131,29 +265,27 @@ double stiffness;
 
 float tableHeight = -0.5;
 
-//------------------------------------------------------------------------------
-// DECLARED GRAPHICS VARIABLES
-//------------------------------------------------------------------------------
+// ray picking of the cloth under the mouse
+cClothPicker clothPicker;
 
-//// grid size
-extern int numX, numY;
-extern size_t total_points;
+// mouse grab of the cloth, kept by the graphics thread and handed over to
+// the thread stepping the cloth
+cClothGrab mouseGrab;
+cTripleBuffer<cClothGrab> clothGrab;
 
-extern int selected_index;
-//
-extern std::vector<GLushort> indices;
-extern std::vector<glm::vec3> X;
-//
-extern int oldX, oldY;
+// distance from the camera at which the grabbed point follows the mouse [m]
+double grabDistance = 0.0;
 
-extern GLint viewport[4];
-extern GLdouble MV[16];
-extern GLdouble P[16];
+// stiffness of the spring pulling the grabbed point [N/m]
+double grabStiffness = 50.0;
 
 //------------------------------------------------------------------------------
 // DECLARED CHAI3D FUNCTIONS
 //------------------------------------------------------------------------------
 
+// create window and OpenGL context
+bool initDisplay(void);
+
 // callback when the window display is resized
 void windowSizeCallback(GLFWwindow* a_window, int a_width, int a_height);
 
@@ -166,24 +298,37 @@ void keyCallback(GLFWwindow* a_window, int a_key, int a_scancode, int a_action,
 // callback when a mouse button is pressed
 void mouseButtonCallback(GLFWwindow* a_window, int a_button, int a_action, int a_mods);
 
+// callback when the mouse moves
+void cursorPosCallback(GLFWwindow* a_window, double a_x, double a_y);
+
 // callback to render graphic scene
 void updateGraphics(void);
 
 // main haptics simulation loop
 void updateHaptics(void);
 
-void clothTableCollision(void);
+// one tick of the haptics simulation
+void stepHaptics(double a_time);
+
+// contact of every device tool and one solver step of the cloth, the force and
+// torque on each tool are stored in its cToolDevice
+void stepPhysics(double a_time, cHapticTimings& a_timings);
+
+// cloth solver loop (multi-rate mode)
+void updatePhysics(void);
+
+// fixed rate haptics loop rendering the contact proxy (multi-rate mode)
+void updateHapticsProxy(void* a_arg);
+
+// run the haptics simulation without display and report timings
+void runHeadless(double a_duration);
+
+// let the cloth hang for a_duration seconds and save its state to a_filename
+void settleCloth(double a_duration, const string& a_filename, unsigned long long a_key);
 
 // function that closes the application
 void close(void);
 
-// compute forces between tool and environment
-cVector3d computeForce(const cVector3d& a_cursor,
-    double a_cursorRadius,
-    const cVector3d& a_spherePos,
-    double a_radius,
-    double a_stiffness);
-
 
 //==============================================================================
 /*
@@ -206,90 +351,244 @@ int main(int argc, char* argv[])
     std::cout << "Keyboard Options:" << std::endl << std::endl;
     std::cout << "[f] - Enable/Disable full screen mode" << std::endl;
     std::cout << "[m] - Enable/Disable display points" << std::endl;
+    std::cout << "[t] - Show/Hide haptic latency overlay" << std::endl;
     std::cout << "[q] - Exit application" << std::endl;
+    std::cout << std::endl;
+    std::cout << "Command line options:" << std::endl << std::endl;
+    std::cout << "-grid N, -grid NxM - Cloth resolution in cells (default 20x20)" << std::endl;
+    std::cout << "-telemetry file    - Write haptic diagnostics to a CSV file" << std::endl;
+    std::cout << "-headless [sec]    - Run without display, driven by a virtual device" << std::endl;
+    std::cout << "-trajectory file   - Virtual device trajectory, one \"t x y z\" per line" << std::endl;
+    std::cout << "-multirate [Hz]    - Cloth solver in its own thread, haptics at 1000-4000 Hz" << std::endl;
+    std::cout << "-solver gel|xpbd|implicit - Cloth dynamics: GEL skeleton (default), flat-array XPBD" << std::endl;
+    std::cout << "                     or backward Euler with conjugate gradients" << std::endl;
+    std::cout << "-kspring k         - Stretch stiffness of the cloth [N/m] (default 25)" << std::endl;
+    std::cout << "-cgiter N          - Most CG iterations per implicit step (default 30)" << std::endl;
+    std::cout << "-threads N         - Threads solving the XPBD constraints (default 1)" << std::endl;
+    std::cout << "-fixedstep [ms]    - Fixed physics step from a time accumulator (default 1 ms)" << std::endl;
+    std::cout << "-substeps N        - Solver substeps per fixed step (default 1)" << std::endl;
+    std::cout << "-maxsteps N        - Most fixed steps run in one tick to catch up (default 4)" << std::endl;
+    std::cout << "-selfcollision     - Keep the cloth from passing through itself" << std::endl;
+    std::cout << "-obstacle          - Drop a sphere on the table for the cloth to drape over" << std::endl;
+    std::cout << "-record file       - Log device positions and forces of every haptic tick" << std::endl;
+    std::cout << "-replay file       - Run a recorded session without display and compare the forces" << std::endl;
+    std::cout << "-statecache dir    - Start from a settled cloth saved in dir, if one matches" << std::endl;
+    std::cout << "-settle [sec]      - Settle the cloth without display, save it to the cache and exit (default 5 s)" << std::endl;
+    std::cout << "-gldebug           - Check for OpenGL errors after every frame" << std::endl;
+    std::cout << "-skin N            - Render vertices per cloth cell side, 1 draws the nodes (default 4)" << std::endl;
+    std::cout << "-skinthreads N     - Threads evaluating the render skin (default 2)" << std::endl;
+    std::cout << "-tool name         - Tool shape: sphere (default), stylus, finger, paddle or hand" << std::endl;
+    std::cout << "-devices N         - Drive one tool per device with N devices, implies -multirate" << std::endl;
+    std::cout << "-hapticcore N|off  - Pin the haptics thread of device i to core N + i (default: last cores)" << std::endl;
     std::cout << std::endl << std::endl;
 
     // parse first arg to try and locate resources
     resourceRoot = string(argv[0]).substr(0, string(argv[0]).find_last_of("/\\") + 1);
     std::cout << string(argv[0]) << std::endl;
 
-    //--------------------------------------------------------------------------
-    // OPENGL - WINDOW DISPLAY
-    //--------------------------------------------------------------------------
+    // fixed step settings
+    double fixedStepMs = 1.0;
+    int fixedSubsteps = 1;
+    int fixedMaxSteps = 4;
 
-    // initialize GLFW library
-    if (!glfwInit())
+    // parse remaining arguments
+    for (int i = 1; i < argc; i++)
     {
-        std::cout << "failed initialization" << std::endl;
-        cSleepMs(1000);
-        return 1;
+        string arg = argv[i];
+        if ((arg == "-grid") && (i + 1 < argc))
+        {
+            int n = sscanf(argv[++i], "%dx%d", &clothParams.numX, &clothParams.numY);
+            if (n == 1)
+            {
+                clothParams.numY = clothParams.numX;
+            }
+        }
+        else if ((arg == "-telemetry") && (i + 1 < argc))
+        {
+            if (!telemetry.start(argv[++i]))
+            {
+                std::cout << "failed to open telemetry file " << argv[i] << std::endl;
+            }
+        }
+        else if (arg == "-headless")
+        {
+            headless = true;
+            if ((i + 1 < argc) && (atof(argv[i + 1]) > 0.0))
+            {
+                headlessDuration = atof(argv[++i]);
+            }
+        }
+        else if ((arg == "-trajectory") && (i + 1 < argc))
+        {
+            trajectoryFile = argv[++i];
+        }
+        else if (arg == "-multirate")
+        {
+            multiRate = true;
+            if ((i + 1 < argc) && (atof(argv[i + 1]) > 0.0))
+            {
+                hapticRate = cClamp(atof(argv[++i]), 1000.0, 4000.0);
+            }
+        }
+        else if ((arg == "-solver") && (i + 1 < argc))
+        {
+            solverType = argv[++i];
+            if ((solverType != "gel") && (solverType != "xpbd") && (solverType != "implicit"))
+            {
+                std::cout << "unknown solver " << solverType << ", using gel" << std::endl;
+                solverType = "gel";
+            }
+        }
+        else if ((arg == "-kspring") && (i + 1 < argc))
+        {
+            clothParams.kSpringElongation = cMax(1.0, atof(argv[++i]));
+        }
+        else if ((arg == "-cgiter") && (i + 1 < argc))
+        {
+            clothParams.cgMaxIterations = cMax(1, atoi(argv[++i]));
+        }
+        else if ((arg == "-threads") && (i + 1 < argc))
+        {
+            numSolverThreads = cMax(1, atoi(argv[++i]));
+        }
+        else if (arg == "-fixedstep")
+        {
+            fixedStepping = true;
+            if ((i + 1 < argc) && (atof(argv[i + 1]) > 0.0))
+            {
+                fixedStepMs = atof(argv[++i]);
+            }
+        }
+        else if ((arg == "-substeps") && (i + 1 < argc))
+        {
+            fixedSubsteps = cMax(1, atoi(argv[++i]));
+        }
+        else if ((arg == "-maxsteps") && (i + 1 < argc))
+        {
+            fixedMaxSteps = cMax(1, atoi(argv[++i]));
+        }
+        else if (arg == "-selfcollision")
+        {
+            selfCollision = true;
+        }
+        else if (arg == "-obstacle")
+        {
+            useObstacle = true;
+        }
+        else if ((arg == "-record") && (i + 1 < argc))
+        {
+            recordFile = argv[++i];
+        }
+        else if ((arg == "-replay") && (i + 1 < argc))
+        {
+            replayFile = argv[++i];
+            headless = true;
+        }
+        else if ((arg == "-statecache") && (i + 1 < argc))
+        {
+            stateCacheDir = argv[++i];
+        }
+        else if (arg == "-gldebug")
+        {
+            glDebug = true;
+        }
+        else if ((arg == "-skin") && (i + 1 < argc))
+        {
+            skinRefinement = cMax(1, atoi(argv[++i]));
+        }
+        else if ((arg == "-skinthreads") && (i + 1 < argc))
+        {
+            numSkinThreads = cMax(1, atoi(argv[++i]));
+        }
+        else if ((arg == "-tool") && (i + 1 < argc))
+        {
+            toolName = argv[++i];
+        }
+        else if ((arg == "-devices") && (i + 1 < argc))
+        {
+            numDevices = cMax(1, atoi(argv[++i]));
+        }
+        else if ((arg == "-hapticcore") && (i + 1 < argc))
+        {
+            string core = argv[++i];
+            hapticCore = (core == "off") ? -2 : cMax(0, atoi(core.c_str()));
+        }
+        else if (arg == "-settle")
+        {
+            settleTime = 5.0;
+            if ((i + 1 < argc) && (atof(argv[i + 1]) > 0.0))
+            {
+                settleTime = atof(argv[++i]);
+            }
+            headless = true;
+        }
     }
 
-    // set error callback
-    glfwSetErrorCallback(errorCallback);
-
-    // compute desired size of window
-    const GLFWvidmode* mode = glfwGetVideoMode(glfwGetPrimaryMonitor());
-    int w = 0.8 * mode->height;
-    int h = 0.5 * mode->height;
-    int x = 0.5 * (mode->width - w);
-    int y = 0.5 * (mode->height - h);
-
-    // set OpenGL version
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 2);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 1);
+    // settled states go to the working directory by default
+    if ((settleTime > 0.0) && stateCacheDir.empty())
+    {
+        stateCacheDir = ".";
+    }
 
-    // set active stereo mode
-    if (stereoMode == C_STEREO_ACTIVE)
+    // a replay runs with the grid, solver and stepping of the recording, the
+    // remaining options have to be given again
+    if (!replayFile.empty())
     {
-        glfwWindowHint(GLFW_STEREO, GL_TRUE);
+        if (!replaySession.open(replayFile))
+        {
+            std::cout << "failed to open session " << replayFile << std::endl;
+            return 1;
+        }
+        const cSessionHeader& header = replaySession.getHeader();
+        clothParams.numX = header.m_gridX;
+        clothParams.numY = header.m_gridY;
+        solverType = string(header.m_solver, strnlen(header.m_solver, sizeof(header.m_solver)));
+        fixedStepping = (header.m_fixedStep > 0.0);
+        if (fixedStepping)
+        {
+            fixedStepMs = 1000.0 * header.m_fixedStep;
+            fixedSubsteps = header.m_fixedSubsteps;
+            fixedMaxSteps = header.m_fixedMaxSteps;
+        }
+        multiRate = false;
+        std::cout << "session recorded with: " << string(header.m_options, strnlen(header.m_options, sizeof(header.m_options))) << std::endl;
+        if (header.m_multiRate)
+        {
+            std::cout << "session recorded in multi-rate mode, forces are replayed in single-rate mode" << std::endl;
+        }
+        if (header.m_numDevices != 1)
+        {
+            std::cout << "session recorded with " << header.m_numDevices << " devices, only single device sessions can be replayed" << std::endl;
+            return 1;
+        }
     }
-    else
+
+    // several devices share the cloth from the physics thread, headless and
+    // replay runs drive a single virtual device
+    if ((headless || !replayFile.empty()) && (numDevices > 1))
     {
-        glfwWindowHint(GLFW_STEREO, GL_FALSE);
+        std::cout << "headless and replay runs use a single device" << std::endl;
+        numDevices = 1;
     }
 
-    // create display context
-    window = glfwCreateWindow(w, h, "CHAI3D", NULL, NULL);
-    if (!window)
+    // a session log holds the ticks of a single device
+    if ((numDevices > 1) && !recordFile.empty())
     {
-        std::cout << "failed to create window" << std::endl;
-        cSleepMs(1000);
-        glfwTerminate();
+        std::cout << "-record needs a single device" << std::endl;
         return 1;
     }
 
+    fixedStep.setup(0.001 * fixedStepMs, fixedSubsteps, fixedMaxSteps);
 
-    // get width and height of window
-    glfwGetWindowSize(window, &windowWidth, &windowHeight);
-
-    // set position of window
-    glfwSetWindowPos(window, x, y);
-
-    // set key callback
-    glfwSetKeyCallback(window, keyCallback);
-
-    // set mouse button callback
-    glfwSetMouseButtonCallback(window, mouseButtonCallback);
-
-    // set resize callback
-    glfwSetWindowSizeCallback(window, windowSizeCallback);
-
-    // set current display context
-    glfwMakeContextCurrent(window);
-
-    // sets the swap interval for the current display context
-    glfwSwapInterval(swapInterval);
+    //--------------------------------------------------------------------------
+    // OPENGL - WINDOW DISPLAY
+    //--------------------------------------------------------------------------
 
-    // initialize GLEW library
-#ifdef GLEW_VERSION
-    if (glewInit() != GLEW_OK)
+    // headless mode runs without window and OpenGL context
+    if (!headless && !initDisplay())
     {
-        cout << "failed to initialize GLEW library" << endl;
-        glfwTerminate();
         return 1;
     }
-#endif
 
     //--------------------------------------------------------------------------
     // WORLD - CAMERA - LIGHTING
@@ -345,61 +644,97 @@ int main(int argc, char* argv[])
     // HAPTIC DEVICE
     //--------------------------------------------------------------------------
 
-    // create a haptic device handler
-    handler = new cHapticDeviceHandler();
-
-    // get a handle to the first haptic device
-    handler->getDevice(hapticDevice, 0);
-
-    // retrieve information about the current haptic device
-    cHapticDeviceInfo hapticDeviceInfo = hapticDevice->getSpecifications();
-
-    // create a 3D tool and add it to the world
-    //tool = new cToolCursor(world);
-    //camera->addChild(tool);
-
-    // connect the haptic device to the tool
-    //tool->setHapticDevice(hapticDevice);
-
-    // open a connection to haptic device
-    hapticDevice->open();
+    if (!replayFile.empty())
+    {
+        // play back the recorded device positions
+        replayDevice = cReplayHapticDevice::create(replaySession);
+        hapticDevice = replayDevice;
+    }
+    else if (headless)
+    {
+        // drive the simulation from a virtual device
+        scriptedDevice = cScriptedHapticDevice::create();
+        if (!trajectoryFile.empty() && !scriptedDevice->loadTrajectory(trajectoryFile))
+        {
+            std::cout << "failed to load trajectory " << trajectoryFile << std::endl;
+            return 1;
+        }
+        hapticDevice = scriptedDevice;
+    }
+    else
+    {
+        // create a haptic device handler
+        handler = new cHapticDeviceHandler();
 
-    // calibrate device (if necessary)
-    hapticDevice->calibrate();
+        // get a handle to the first haptic device
+        handler->getDevice(hapticDevice, 0);
 
-    // retrieve information about the current haptic device
-    //cHapticDeviceInfo info = hapticDevice->getSpecifications();
+        // the other devices, as many as are connected
+        int numConnected = cMax(1, (int)handler->getNumDevices());
+        if (numDevices > numConnected)
+        {
+            std::cout << "only " << numConnected << " haptic devices connected" << std::endl;
+            numDevices = numConnected;
+        }
+    }
 
-    // display a reference frame if haptic device supports orientations
-    if (hapticDeviceInfo.m_sensedRotation == true)
+    // the devices share the cloth stepped by the physics thread
+    if (numDevices > 1)
     {
-        // display reference frame
-        device->setShowFrame(false);
-
-        // set the size of the reference frame
-        device->setFrameSize(0.05);
+        multiRate = true;
     }
 
-    // if the device has a gripper, enable the gripper to simulate a user switch
-    hapticDevice->setEnableGripperUserSwitch(true);
-
     // desired workspace radius of the cursor
     cursorWorkspaceRadius = 0.2;
 
-    // read the scale factor between the physical workspace of the haptic
-    // device and the virtual workspace defined for the tool
-    workspaceScaleFactor = cursorWorkspaceRadius / hapticDeviceInfo.m_workspaceRadius;
-
     // define a scale factor between the force perceived at the cursor and the
     // forces actually sent to the haptic device
     deviceForceScale = 5.0;
 
-    // create a large sphere that represents the haptic device
+    // tool that represents each haptic device, a large sphere unless another
+    // shape was requested
     deviceRadius = 0.1;
-    device = new cShapeSphere(deviceRadius);
-    world->addChild(device);
-    device->m_material->setWhite();
-    device->m_material->setShininess(100);
+    if (!cCreateToolShape(toolName, deviceRadius, toolShape))
+    {
+        std::cout << "unknown tool " << toolName << ", using a sphere" << std::endl;
+        cCreateToolShape("sphere", deviceRadius, toolShape);
+    }
+
+    // open the devices, their workspaces side by side along x
+    for (int i = 0; i < numDevices; i++)
+    {
+        cGenericHapticDevicePtr handle = hapticDevice;
+        if (i > 0)
+        {
+            handler->getDevice(handle, i);
+        }
+        cToolDevice* toolDevice = new cToolDevice(i);
+        double offset = (i - 0.5 * (numDevices - 1)) * 1.5 * cursorWorkspaceRadius;
+        toolDevice->open(handle, cursorWorkspaceRadius, cVector3d(offset, 0.0, 0.0));
+
+        // create the tool mesh
+        toolDevice->m_object = new cMesh();
+        toolShape.createMesh(toolDevice->m_object);
+        toolDevice->m_object->setLocalPos(toolDevice->m_offset);
+        world->addChild(toolDevice->m_object);
+        toolDevice->m_object->m_material->setWhite();
+        toolDevice->m_object->m_material->setShininess(100);
+
+        // display a reference frame if haptic device supports orientations
+        if (toolDevice->m_info.m_sensedRotation == true)
+        {
+            // display reference frame
+            toolDevice->m_object->setShowFrame(false);
+
+            // set the size of the reference frame
+            toolDevice->m_object->setFrameSize(0.05);
+        }
+
+        toolDevices.push_back(toolDevice);
+    }
+
+    // retrieve information about the first haptic device
+    cHapticDeviceInfo hapticDeviceInfo = toolDevices[0]->m_info;
 
     // interaction stiffness between tool and deformable model 
     stiffness = 100;
@@ -413,7 +748,7 @@ int main(int argc, char* argv[])
     //-----------------------------------------------------------------------
 
     float toolRadius = 0.1;
-    double maxStiffness = hapticDeviceInfo.m_maxLinearStiffness / workspaceScaleFactor;
+    double maxStiffness = toolDevices[0]->m_maxProxyStiffness;
 
     tableObject = new cMesh();
 
@@ -450,31 +785,34 @@ int main(int argc, char* argv[])
     // set the position of the object at the center of the world
     tableObject->setLocalPos(0.0, tableHeight, 0.0);
 
-    // set graphic properties
-    bool fileload;
-    tableObject->m_texture = cTexture2d::create();
-    fileload = tableObject->m_texture->loadFromFile(RESOURCE_PATH("../resources/images/brownboard.jpg"));
-    if (!fileload)
+    // set graphic properties (textures are not needed without display)
+    if (!headless)
     {
+        bool fileload;
+        tableObject->m_texture = cTexture2d::create();
+        fileload = tableObject->m_texture->loadFromFile(RESOURCE_PATH("../resources/images/brownboard.jpg"));
+        if (!fileload)
+        {
 #if defined(_MSVC)
-        fileload = tableObject->m_texture->loadFromFile("../../../bin/resources/images/brownboard.jpg");
+            fileload = tableObject->m_texture->loadFromFile("../../../bin/resources/images/brownboard.jpg");
 #endif
-    }
-    if (!fileload)
-    {
-        cout << "Error - Texture image failed to load correctly." << endl;
-        close();
-        return (-1);
-    }
+        }
+        if (!fileload)
+        {
+            cout << "Error - Texture image failed to load correctly." << endl;
+            close();
+            return (-1);
+        }
 
-    // enable texture mapping
-    tableObject->setUseTexture(true);
-    tableObject->m_material->setWhite();
+        // enable texture mapping
+        tableObject->setUseTexture(true);
 
-    // create normal map from texture data
-    cNormalMapPtr normalMap = cNormalMap::create();
-    normalMap->createMap(tableObject->m_texture);
-    tableObject->m_normalMap = normalMap;
+        // create normal map from texture data
+        cNormalMapPtr normalMap = cNormalMap::create();
+        normalMap->createMap(tableObject->m_texture);
+        tableObject->m_normalMap = normalMap;
+    }
+    tableObject->m_material->setWhite();
 
     // set haptic properties
     tableObject->m_material->setStiffness(0.3 * maxStiffness);
@@ -483,6 +821,25 @@ int main(int argc, char* argv[])
     tableObject->m_material->setTextureLevel(0.2);
     tableObject->m_material->setHapticTriangleSides(true, false);
 
+    //-----------------------------------------------------------------------
+    // create obstacle mesh
+    //-----------------------------------------------------------------------
+
+    if (useObstacle)
+    {
+        const double obstacleRadius = 0.12;
+        obstacleObject = new cMesh();
+        cCreateSphere(obstacleObject, obstacleRadius, 32, 32);
+        obstacleObject->createAABBCollisionDetector(toolRadius);
+        world->addChild(obstacleObject);
+        obstacleObject->setLocalPos(0.0, tableHeight + obstacleRadius, 0.0);
+
+        obstacleObject->m_material->setRedCrimson();
+        obstacleObject->m_material->setStiffness(0.3 * maxStiffness);
+        obstacleObject->m_material->setStaticFriction(0.3);
+        obstacleObject->m_material->setDynamicFriction(0.2);
+    }
+
     //-----------------------------------------------------------------------
     // create untouchable cloth mesh
     //-----------------------------------------------------------------------
@@ -496,41 +853,26 @@ int main(int argc, char* argv[])
     // Since we want to see our polygons from both sides, we disable culling.
     clothObject->setUseCulling(false);
 
-    initCloth();
+    cloth = new cClothModel(clothParams);
+    cloth->initCloth();
 
-    for (int i = 0; i < indices.size(); i += 3) {
-        // define triangle points
-        cVector3d p0 = cVector3d(X[indices[i + 0]].x, X[indices[i + 0]].y, X[indices[i + 0]].z);
-        cVector3d p1 = cVector3d(X[indices[i + 1]].x, X[indices[i + 1]].y, X[indices[i + 1]].z);
-        cVector3d p2 = cVector3d(X[indices[i + 2]].x, X[indices[i + 2]].y, X[indices[i + 2]].z);
-
-        // define a triangle color
-        cColorf color;
-        color.set((X[indices[i + 0]].x + 1) * 0.5, (X[indices[i + 0]].z + 1) * 0.5, 0.5);
-
-        // create three new vertices
-        int vertex0 = clothObject->newVertex();
-        int vertex1 = clothObject->newVertex();
-        int vertex2 = clothObject->newVertex();
-
-        // set position of each vertex
-        clothObject->m_vertices->setLocalPos(vertex0, p0);
-        clothObject->m_vertices->setLocalPos(vertex1, p1);
-        clothObject->m_vertices->setLocalPos(vertex2, p2);
-
-        // assign color to each vertex
-        clothObject->m_vertices->setColor(vertex0, color);
-        clothObject->m_vertices->setColor(vertex1, color);
-        clothObject->m_vertices->setColor(vertex2, color);
-
-        // create new triangle from vertices
-        clothObject->newTriangle(vertex0, vertex1, vertex2);
+    // create shared vertices and triangles from the cloth grid, or a finer
+    // skin over it
+    if (skinRefinement > 1)
+    {
+        if (!headless && (numSkinThreads > 1))
+        {
+            skinPool = new cThreadPool(numSkinThreads);
+            clothSkin.setThreadPool(skinPool);
+        }
+        clothSkin.create(clothObject, cloth->getNumNodesX(), cloth->getNumNodesY(), skinRefinement, cloth->m_X);
+    }
+    else
+    {
+        clothMesh.create(clothObject, cloth->m_X, cloth->m_indices);
     }
 
-    // compute surface normals
-    clothObject->computeAllNormals();
-
-    // we indicate that we ware rendering triangles by using specific colors for each of them (see above)
+    // we indicate that we are rendering triangles by using specific colors for each vertex
     clothObject->setUseVertexColors(true);
     
     //-----------------------------------------------------------------------
@@ -547,70 +889,114 @@ int main(int argc, char* argv[])
     // build dynamic vertices
     defObject->buildVertices();
 
-    // set default properties for skeleton nodes
-    cGELSkeletonNode::s_default_radius = 0.018;  // [m]
-    cGELSkeletonNode::s_default_kDampingPos = 10.0;
-    cGELSkeletonNode::s_default_kDampingRot = 0.6;
-    cGELSkeletonNode::s_default_mass = 0.0004; // [kg]
+    // set default display properties for skeleton nodes, physical properties
+    // are taken from the cloth parameters
     cGELSkeletonLink::s_default_color.setBlueAqua();
     cGELSkeletonNode::s_default_showFrame = false;
-
-    cGELSkeletonNode::s_default_useGravity = true;
-    cGELSkeletonNode::s_default_gravity.set(0.00, -9.81, 0.00);
-    modelRadius = cGELSkeletonNode::s_default_radius;
+    modelRadius = clothParams.nodeRadius;
 
     // use internal skeleton as deformable model
     defObject->m_useSkeletonModel = true;
 
-    // create an array of nodes
-    for (int y = 0; y < 21; y++)
+    // create nodes and links from the cloth model, the XPBD and implicit
+    // solvers keep their own flat arrays and leave the deformable mesh empty
+    if (solverType == "xpbd")
     {
-        for (int x = 0; x < 21; x++)
+        cXPBDClothSolver* xpbd = new cXPBDClothSolver(cloth);
+        if (numSolverThreads > 1)
         {
-            cGELSkeletonNode* newNode = new cGELSkeletonNode();
-            //std::cout << "R: " << newNode->m_color.getR() << std::endl;
-            defObject->m_nodes.push_front(newNode);
-            newNode->m_pos.set((-0.4 + 0.04 * (double)x), -0.2, (-0.4 + 0.04 * (double)y));
-            nodes[x][y] = newNode;
+            solverPool = new cThreadPool(numSolverThreads);
+            xpbd->setThreadPool(solverPool);
         }
+        clothSolver = xpbd;
+    }
+    else if (solverType == "implicit")
+    {
+        clothSolver = new cImplicitClothSolver(cloth);
+    }
+    else
+    {
+        cloth->buildSkeleton(defObject);
+        clothSolver = new cGELClothSolver(defWorld, cloth);
     }
 
-    // set corner nodes as fixed
-    nodes[0][0]->m_fixed = true;
-    nodes[0][20]->m_fixed = true;
-    nodes[20][0]->m_fixed = true;
-    nodes[20][20]->m_fixed = true;
+    // resolve table contact at the end of every cloth step
+    tableCollider.setup(tableObject, 0.0);
+    clothSolver->addCollider(&tableCollider);
+
+    // keep the cloth 5 mm off the obstacles, sampled on 1 cm cells
+    if (obstacleObject != NULL)
+    {
+        meshCollider.setup(cloth->m_indices, 0.005);
+        meshCollider.addObstacle(obstacleObject, 0.01);
+        clothSolver->addCollider(&meshCollider);
+    }
 
-    // set default physical properties for links
-    cGELSkeletonLink::s_default_kSpringElongation = 25.0;  // [N/m]
-    cGELSkeletonLink::s_default_kSpringFlexion = 0.000005;   // [Nm/RAD]
-    cGELSkeletonLink::s_default_kSpringTorsion = 0.5;   // [Nm/RAD]
+    // keep the layers a quarter of a cell apart, in a grid of two cells
+    if (selfCollision)
+    {
+        double spacing = clothParams.size / cMax(clothParams.numX, clothParams.numY);
+        selfCollider.setup(cloth->m_indices, 2.0 * spacing, 0.25 * spacing);
+        clothSolver->addCollider(&selfCollider);
+    }
 
-    // create links between nodes
-    for (int y = 0; y < 20; y++)
+    // cached states are keyed by the cloth parameters, the solver and the
+    // objects the cloth can rest on
+    string stateFile;
+    unsigned long long stateKey = 0;
+    if (!stateCacheDir.empty())
     {
-        for (int x = 0; x < 20; x++)
+        unsigned int scene = ((obstacleObject != NULL) ? 1 : 0) | (selfCollision ? 2 : 0);
+        stateKey = cComputeClothStateKey(clothParams, solverType, scene);
+        char name[96];
+        snprintf(name, sizeof(name), "cloth-%dx%d-%s-%016llx.state", clothParams.numX, clothParams.numY, solverType.c_str(), stateKey);
+        stateFile = stateCacheDir + "/" + name;
+
+        // skip the initial fall of the cloth
+        if (settleTime <= 0.0)
         {
-            cGELSkeletonLink* newLinkX0 = new cGELSkeletonLink(nodes[x + 0][y + 0], nodes[x + 1][y + 0]);
-            cGELSkeletonLink* newLinkX1 = new cGELSkeletonLink(nodes[x + 0][y + 1], nodes[x + 1][y + 1]);
-            cGELSkeletonLink* newLinkY0 = new cGELSkeletonLink(nodes[x + 0][y + 0], nodes[x + 0][y + 1]);
-            cGELSkeletonLink* newLinkY1 = new cGELSkeletonLink(nodes[x + 1][y + 0], nodes[x + 1][y + 1]);
-            defObject->m_links.push_front(newLinkX0);
-            defObject->m_links.push_front(newLinkX1);
-            defObject->m_links.push_front(newLinkY0);
-            defObject->m_links.push_front(newLinkY1);
+            if (cLoadClothState(stateFile, cloth, clothSolver, stateKey))
+            {
+                std::cout << "settled cloth loaded from " << stateFile << std::endl;
+            }
+            else
+            {
+                std::cout << "no settled cloth in " << stateCacheDir << ", run with -settle to create " << name << std::endl;
+            }
         }
     }
 
+    // index nodes for the contact of each tool
+    for (int i = 0; i < numDevices; i++)
+    {
+        toolDevices[i]->m_contact.setup(cloth, toolShape, modelRadius, stiffness);
+    }
+
     // connect skin (mesh) to skeleton (GEM)
     defObject->connectVerticesToSkeleton(true);
 
-    // show/hide underlying dynamic skeleton model
-    defObject->m_showSkeletonModel = true;
+    // show/hide underlying dynamic skeleton model. the skeleton is drawn from
+    // the live nodes, unsynchronized with the haptics thread, so it is only
+    // shown on request (debug view)
+    defObject->m_showSkeletonModel = false;
+
+    // initialize snapshot buffers with the initial positions
+    for (int i = 0; i < 3; i++)
+    {
+        clothSnapshot.getBuffer(i).m_tick = 0;
+        cloth->writeSnapshot(clothSnapshot.getBuffer(i));
+    }
+
+    // nothing is grabbed at first
+    mouseGrab.m_active = false;
+    for (int i = 0; i < 3; i++)
+    {
+        clothGrab.getBuffer(i) = mouseGrab;
+    }
 
     //--------------------------------------------------------------------------
-    // WIDGETS
-    //--------------------------------------------------------------------------
+    // WIDGETS
+    //--------------------------------------------------------------------------
 
     // create a font
     cFontPtr font = NEW_CFONTCALIBRI20();
@@ -620,18 +1006,124 @@ int main(int argc, char* argv[])
     camera->m_frontLayer->addChild(labelHapticRate);
     labelHapticRate->m_fontColor.setWhite();
 
+    // create labels to display the haptic latency of each phase
+    for (int i = 0; i < C_NUM_HAPTIC_PHASES; i++)
+    {
+        labelTimings[i] = new cLabel(font);
+        camera->m_frontLayer->addChild(labelTimings[i]);
+        labelTimings[i]->m_fontColor.setWhite();
+    }
+
+    // create labels to display the rate and latency of each device
+    for (int i = 0; (numDevices > 1) && (i < numDevices); i++)
+    {
+        labelDevices.push_back(new cLabel(font));
+        camera->m_frontLayer->addChild(labelDevices[i]);
+        labelDevices[i]->m_fontColor.setWhite();
+    }
+
 
     //--------------------------------------------------------------------------
     // START SIMULATION
     //--------------------------------------------------------------------------
 
-    // create a thread which starts the main haptics rendering loop
-    hapticsThread = new cThread();
-    hapticsThread->start(updateHaptics, CTHREAD_PRIORITY_HAPTICS);
+    // offline settling, no device involved
+    if (settleTime > 0.0)
+    {
+        settleCloth(settleTime, stateFile, stateKey);
+        return (0);
+    }
+
+    // log the session once the device and the cloth are set up
+    if (!recordFile.empty())
+    {
+        cSessionHeader header;
+        memset(&header, 0, sizeof(header));
+        header.m_gridX = clothParams.numX;
+        header.m_gridY = clothParams.numY;
+        strncpy(header.m_solver, solverType.c_str(), sizeof(header.m_solver) - 1);
+        if (fixedStepping)
+        {
+            header.m_fixedStep = fixedStep.getStep();
+            header.m_fixedSubsteps = fixedStep.getNumSubsteps();
+            header.m_fixedMaxSteps = fixedMaxSteps;
+        }
+        header.m_multiRate = multiRate ? 1 : 0;
+        header.m_numDevices = numDevices;
+        header.m_workspaceRadius = hapticDeviceInfo.m_workspaceRadius;
+        header.m_maxLinearForce = hapticDeviceInfo.m_maxLinearForce;
+        header.m_maxLinearStiffness = hapticDeviceInfo.m_maxLinearStiffness;
+        string options;
+        for (int i = 1; i < argc; i++)
+        {
+            options += ((i > 1) ? " " : "") + string(argv[i]);
+        }
+        strncpy(header.m_options, options.c_str(), sizeof(header.m_options) - 1);
+
+        // room for an hour of ticks, pages are only allocated once written
+        unsigned long long capacity = (unsigned long long)(3600.0 * (multiRate ? hapticRate : 1000.0));
+        if (!sessionRecorder.start(recordFile, header, capacity))
+        {
+            std::cout << "failed to create session " << recordFile << std::endl;
+            return 1;
+        }
+    }
 
     // setup callback when application exits
     atexit(close);
 
+    if (headless)
+    {
+        runHeadless(headlessDuration);
+        return (0);
+    }
+
+    // pin the haptics thread of each device to its own core, from the last
+    // core down if there are cores left for the graphics and physics threads
+    int numCores = (int)std::thread::hardware_concurrency();
+    for (int i = 0; i < numDevices; i++)
+    {
+        if (hapticCore >= 0)
+        {
+            toolDevices[i]->m_core = hapticCore + i;
+        }
+        else if ((hapticCore == -1) && (numCores > numDevices + 1))
+        {
+            toolDevices[i]->m_core = numCores - 1 - i;
+        }
+    }
+
+    if (multiRate)
+    {
+        // initialize buffers shared by the physics and haptics threads
+        for (int i = 0; i < numDevices; i++)
+        {
+            toolDevices[i]->resetBuffers();
+        }
+        simulationRunning = true;
+        simulationFinished = false;
+        numHapticsThreads = numDevices;
+
+        // create a thread which runs the cloth solver
+        physicsFinished = false;
+        physicsThread = new cThread();
+        physicsThread->start(updatePhysics, CTHREAD_PRIORITY_GRAPHICS);
+
+        // create one thread per device which renders its contact proxy at a
+        // fixed rate
+        for (int i = 0; i < numDevices; i++)
+        {
+            toolDevices[i]->m_thread = new cThread();
+            toolDevices[i]->m_thread->start(updateHapticsProxy, CTHREAD_PRIORITY_HAPTICS, toolDevices[i]);
+        }
+    }
+    else
+    {
+        // create a thread which starts the main haptics rendering loop
+        toolDevices[0]->m_thread = new cThread();
+        toolDevices[0]->m_thread->start(updateHaptics, CTHREAD_PRIORITY_HAPTICS);
+    }
+
     // start the main graphics rendering loop
     windowSizeCallback(window, windowWidth, windowHeight);
 
@@ -664,6 +1156,90 @@ int main(int argc, char* argv[])
     return (0);
 }
 
+//------------------------------------------------------------------------------
+
+bool initDisplay(void)
+{
+    // initialize GLFW library
+    if (!glfwInit())
+    {
+        std::cout << "failed initialization" << std::endl;
+        cSleepMs(1000);
+        return (false);
+    }
+
+    // set error callback
+    glfwSetErrorCallback(errorCallback);
+
+    // compute desired size of window
+    const GLFWvidmode* mode = glfwGetVideoMode(glfwGetPrimaryMonitor());
+    int w = 0.8 * mode->height;
+    int h = 0.5 * mode->height;
+    int x = 0.5 * (mode->width - w);
+    int y = 0.5 * (mode->height - h);
+
+    // set OpenGL version
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 2);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 1);
+
+    // set active stereo mode
+    if (stereoMode == C_STEREO_ACTIVE)
+    {
+        glfwWindowHint(GLFW_STEREO, GL_TRUE);
+    }
+    else
+    {
+        glfwWindowHint(GLFW_STEREO, GL_FALSE);
+    }
+
+    // create display context
+    window = glfwCreateWindow(w, h, "CHAI3D", NULL, NULL);
+    if (!window)
+    {
+        std::cout << "failed to create window" << std::endl;
+        cSleepMs(1000);
+        glfwTerminate();
+        return (false);
+    }
+
+
+    // get width and height of window
+    glfwGetWindowSize(window, &windowWidth, &windowHeight);
+
+    // set position of window
+    glfwSetWindowPos(window, x, y);
+
+    // set key callback
+    glfwSetKeyCallback(window, keyCallback);
+
+    // set mouse button callback
+    glfwSetMouseButtonCallback(window, mouseButtonCallback);
+
+    // set mouse move callback
+    glfwSetCursorPosCallback(window, cursorPosCallback);
+
+    // set resize callback
+    glfwSetWindowSizeCallback(window, windowSizeCallback);
+
+    // set current display context
+    glfwMakeContextCurrent(window);
+
+    // sets the swap interval for the current display context
+    glfwSwapInterval(swapInterval);
+
+    // initialize GLEW library
+#ifdef GLEW_VERSION
+    if (glewInit() != GLEW_OK)
+    {
+        cout << "failed to initialize GLEW library" << endl;
+        glfwTerminate();
+        return (false);
+    }
+#endif
+
+    return (true);
+}
+
 //---------------------------------------------------------------------------
 
 void windowSizeCallback(GLFWwindow* a_window, int a_width, int a_height)
@@ -775,6 +1351,20 @@ void keyCallback(GLFWwindow* a_window, int a_key, int a_scancode, int a_action,
         }
     }
 
+    // option - show/hide latency overlay
+    else if (a_key == GLFW_KEY_T)
+    {
+        showTimings = !showTimings;
+        for (int i = 0; i < C_NUM_HAPTIC_PHASES; i++)
+        {
+            labelTimings[i]->setShowEnabled(showTimings);
+        }
+        for (size_t i = 0; i < labelDevices.size(); i++)
+        {
+            labelDevices[i]->setShowEnabled(showTimings);
+        }
+    }
+
     // option - toggle vertical mirroring
     else if (a_key == GLFW_KEY_M)
     {
@@ -783,31 +1373,61 @@ void keyCallback(GLFWwindow* a_window, int a_key, int a_scancode, int a_action,
     }
 }
 
-void cursorPositionCallback(GLFWwindow* window, double xpos, double ypos) {
-
-}
-
-//------------------------------------------------------------------------------
-
 void close(void)
 {
     // stop the simulation
     simulationRunning = false;
 
-    // wait for graphics and haptics loops to terminate
-    while (!simulationFinished) { cSleepMs(100); }
+    // wait for graphics, haptics and physics loops to terminate
+    while (!simulationFinished || !physicsFinished) { cSleepMs(100); }
+
+    // close haptic devices
+    for (size_t i = 0; i < toolDevices.size(); i++)
+    {
+        toolDevices[i]->close();
+    }
+
+    // rate and latency of each device
+    if (!headless)
+    {
+        for (size_t i = 0; i < toolDevices.size(); i++)
+        {
+            std::cout << toolDevices[i]->getSummary() << std::endl;
+        }
+    }
+
+    // write remaining diagnostics
+    telemetry.stop();
 
-    // close haptic device
-    hapticDevice->close();
+    // close the session log
+    if (sessionRecorder.isEnabled())
+    {
+        std::cout << "session: " << sessionRecorder.getNumRecords() << " ticks recorded to " << recordFile;
+        if (sessionRecorder.getNumDropped() > 0)
+        {
+            std::cout << ", " << sessionRecorder.getNumDropped() << " dropped";
+        }
+        std::cout << std::endl;
+        if (!sessionRecorder.stop())
+        {
+            std::cout << "failed to cut session " << recordFile << " to its records, the file keeps its capacity" << std::endl;
+        }
+    }
 
     // delete resources
-    delete hapticsThread;
+    for (size_t i = 0; i < toolDevices.size(); i++)
+    {
+        delete toolDevices[i];
+    }
+    delete physicsThread;
     delete world;
     delete handler;
 
     // clear graphics simulation
-    X.clear();
-    indices.clear();
+    delete clothSolver;
+    delete solverPool;
+    delete skinPool;
+    delete cloth;
 }
 
 //------------------------------------------------------------------------------
@@ -819,51 +1439,87 @@ void updateGraphics(void)
     /////////////////////////////////////////////////////////////////////
 
     // display haptic rate data
-    labelHapticRate->setText(cStr(freqCounterGraphics.getFrequency(), 0) + " Hz / " +
-        cStr(freqCounterHaptics.getFrequency(), 0) + " Hz");
+    string hapticRates;
+    int numCandidates = 0;
+    for (int i = 0; i < numDevices; i++)
+    {
+        hapticRates += cStr(toolDevices[i]->m_freqCounter.getFrequency(), 0) + " Hz / ";
+        numCandidates += toolDevices[i]->m_contact.getNumCandidates();
+    }
+    labelHapticRate->setText(cStr(freqCounterGraphics.getFrequency(), 0) + " Hz / " + hapticRates +
+        (multiRate ? cStr(freqCounterPhysics.getFrequency(), 0) + " Hz physics / " : string("")) +
+        cStr(numCandidates) + " contact candidates");
 
     // update position of label
     labelHapticRate->setLocalPos((int)(0.5 * (windowWidth - labelHapticRate->getWidth())), 15);
 
+    // display haptic latency of each phase
+    if (showTimings)
+    {
+        for (int i = 0; i < C_NUM_HAPTIC_PHASES; i++)
+        {
+            // contact and dynamics run in the physics thread in multi-rate mode
+            bool physicsPhase = (i == C_PHASE_CONTACT) || (i == C_PHASE_DYNAMICS) || (i == C_PHASE_GLOBAL_POSITIONS);
+            const cHapticTimings& timings = (multiRate && physicsPhase) ? physicsTimings : toolDevices[0]->m_timings;
+            labelTimings[i]->setText(string(cHapticTimings::getPhaseName(i)) + ": " +
+                timings.getHistogram(i).getSummary());
+            labelTimings[i]->setLocalPos(10, windowHeight - 25 * (i + 1));
+        }
+
+        // then one line per device
+        for (size_t i = 0; i < labelDevices.size(); i++)
+        {
+            labelDevices[i]->setText(toolDevices[i]->getSummary());
+            labelDevices[i]->setLocalPos(10, windowHeight - 25 * (C_NUM_HAPTIC_PHASES + 1 + (int)i));
+        }
+    }
 
-    // update skins deformable objects
-    defWorld->updateSkins(true);
 
     /////////////////////////////////////////////////////////////////////
     // RENDER SCENE
     /////////////////////////////////////////////////////////////////////
 
+    // update the cloth from the newest complete snapshot before it is drawn
+    if (clothSnapshot.acquire())
+    {
+        if (skinRefinement > 1)
+        {
+            clothSkin.update(clothSnapshot.getReadBuffer().m_X);
+        }
+        else
+        {
+            clothMesh.update(clothSnapshot.getReadBuffer().m_X);
+        }
+    }
+
     // update shadow maps (if any)
     world->updateShadowMaps(false, mirroredDisplay);
 
-    // render world
+    // render world, the GPU works through the commands while the swap paces
+    // the loop, no need to wait for it here
     camera->renderView(windowWidth, windowHeight);
 
-    // render cloth
-    //drawGrid();
-    for (int i = 0; i < clothObject->getNumVertices(); i+=3) {
-        cVector3d p0 = cVector3d(X[indices[i + 0]].x, X[indices[i + 0]].y, X[indices[i + 0]].z);
-        cVector3d p1 = cVector3d(X[indices[i + 1]].x, X[indices[i + 1]].y, X[indices[i + 1]].z);
-        cVector3d p2 = cVector3d(X[indices[i + 2]].x, X[indices[i + 2]].y, X[indices[i + 2]].z);
-
-        clothObject->m_vertices->setLocalPos(i, p0);
-        clothObject->m_vertices->setLocalPos(i+1, p1);
-        clothObject->m_vertices->setLocalPos(i+2, p2);
+    // check for OpenGL errors, each check waits for the GPU
+    if (glDebug)
+    {
+        GLenum err;
+        while ((err = glGetError()) != GL_NO_ERROR)
+        {
+            cout << "Error: " << gluErrorString(err) << endl;
+        }
     }
-
-    // wait until all GL commands are completed
-    glFinish();
-
-    // check for any OpenGL errors
-    GLenum err;
-    err = glGetError();
-    if (err != GL_NO_ERROR) cout << "Error:  %s\n" << gluErrorString(err);
 }
 
 //------------------------------------------------------------------------------
 
 void updateHaptics(void)
 {
+    cToolDevice* toolDevice = toolDevices[0];
+    if ((toolDevice->m_core >= 0) && !cPinCurrentThread(toolDevice->m_core))
+    {
+        toolDevice->m_core = -1;
+    }
+
     // initialize precision clock
     cPrecisionClock clock;
     clock.reset();
@@ -873,154 +1529,610 @@ void updateHaptics(void)
     simulationFinished = false;
 
     // main haptic simulation loop
+    bool firstTick = true;
     while (simulationRunning)
     {
-        // stop clock
-        double time = cMin(0.001, clock.stop());
+        // stop clock, the fixed step accumulator keeps time beyond 1 ms
+        double interval = clock.stop();
+        double time = fixedStepping ? interval : cMin(0.001, interval);
+
+        // record time between two ticks
+        if (!firstTick)
+        {
+            toolDevice->m_timings.getHistogram(C_PHASE_INTERVAL).record((unsigned long long)(1e9 * interval));
+        }
+        firstTick = false;
 
         // restart clock
         clock.start(true);
 
-        // read position from haptic device
-        cVector3d pos;
-        hapticDevice->getPosition(pos);
-        pos.mul(workspaceScaleFactor);
-        device->setLocalPos(pos);
+        // compute one tick
+        stepHaptics(time);
+
+        // signal frequency counter
+        toolDevice->m_freqCounter.signal(1);
+    }
+
+    // exit haptics thread
+    simulationFinished = true;
+}
+
+//------------------------------------------------------------------------------
+
+void stepHaptics(double a_time)
+{
+    cToolDevice* toolDevice = toolDevices[0];
+    cHapticTimings& timings = toolDevice->m_timings;
+    timings.beginTick();
+
+    // read position and orientation from haptic device
+    cVector3d devicePos;
+    toolDevice->readPose(toolDevice->m_tool, devicePos);
 
-        // clear all external forces
-        defWorld->clearExternalForces();
+    timings.mark(C_PHASE_DEVICE_READ);
 
-        // compute reaction forces
-        cVector3d force(0.0, 0.0, 0.0);
-        for (int y = 0; y < 21; y++)
+    // advance the cloth and compute the reaction force and torque on the tool
+    cVector3d force;
+    cVector3d torque;
+    if (fixedStepping)
+    {
+        // whole fixed steps due since the last tick, then blend the forces of
+        // the last two steps by the time left in the accumulator. contact and
+        // dynamics time is summed over the steps, zero in ticks that run none
+        int numSteps = fixedStep.advance(a_time);
+        timings.include(C_PHASE_CONTACT);
+        timings.include(C_PHASE_DYNAMICS);
+        for (int s = 0; s < numSteps; s++)
         {
-            for (int x = 0; x < 21; x++)
+            previousForce = currentForce;
+            previousTorque = currentTorque;
+            for (int k = 0; k < fixedStep.getNumSubsteps(); k++)
             {
-                cVector3d nodePos = nodes[x][y]->m_pos;
-                cVector3d f = computeForce(pos, deviceRadius, nodePos, modelRadius, stiffness);
-                cVector3d tmpfrc = -1.0 * f;
-
-                X[y * 21 + x].x = nodePos.x();
-                X[y * 21 + x].y = nodePos.y() + 0.01;
-                X[y * 21 + x].z = nodePos.z();
-
-                if (nodePos.get(1) - tableHeight < 0)
-                    std::cout << cGELSkeletonLink::s_default_kSpringElongation * (tableHeight - nodePos.get(1)) << std::endl;
-                if (nodePos.get(1) - tableHeight < 0) {
-                    tmpfrc.y(tmpfrc.get(1) + 
-                        cGELSkeletonLink::s_default_kSpringElongation * (tableHeight - nodePos.get(1)));
-                }
-                nodes[x][y]->setExternalForce(tmpfrc);
-                force.add(f);
+                stepPhysics(fixedStep.getSubstep(), timings);
             }
+            currentForce = toolDevice->m_force;
+            currentTorque = toolDevice->m_torque;
+        }
+        double alpha = fixedStep.getAlpha();
+        force = (1.0 - alpha) * previousForce + alpha * currentForce;
+        torque = (1.0 - alpha) * previousTorque + alpha * currentTorque;
+    }
+    else
+    {
+        stepPhysics(a_time, timings);
+        force = toolDevice->m_force;
+        torque = toolDevice->m_torque;
+    }
+
+    //// scale force, the torque arm is scaled with the workspace too
+    double scale = toolDevice->m_workspaceScaleFactor;
+    force.mul(deviceForceScale / scale);
+    torque.mul(deviceForceScale / (scale * scale));
+
+    //// send forces to haptic device
+    toolDevice->m_device->setForceAndTorque(force, torque);
+
+    // log the tick
+    sessionRecorder.record(a_time, devicePos, toolDevice->m_tool.m_rot, force, torque);
+
+    timings.mark(C_PHASE_SET_FORCE);
+
+    /* triangle objects */
+    // compute global reference frames for each object
+    world->computeGlobalPositions(true);
+
+    timings.mark(C_PHASE_GLOBAL_POSITIONS);
+    timings.endTick();
+
+    // update position and orientation of tool
+    //tool->updateFromDevice();
+
+    //// compute interaction forces
+    //tool->computeInteractionForces();
+
+    //// send forces to haptic device
+    //tool->applyToDevice();
+}
+
+//------------------------------------------------------------------------------
+
+void stepPhysics(double a_time, cHapticTimings& a_timings)
+{
+    // clear all external forces
+    clothSolver->clearExternalForces();
+
+    // compute reaction forces of each tool on the nodes selected by its broad
+    // phase, nodes touched by several tools add up in the solver
+    for (int i = 0; i < numDevices; i++)
+    {
+        cToolDevice* toolDevice = toolDevices[i];
+        toolDevice->m_force = toolDevice->m_contact.computeForces(toolDevice->m_tool.m_pos,
+            toolDevice->m_tool.m_rot, toolDevice->m_torque);
+        toolDevice->m_contact.applyForces(clothSolver);
+
+        // record diagnostics
+        if (toolDevice->m_force.lengthsq() > 0.0)
+        {
+            telemetry.record(hapticTick, C_TELEMETRY_TOOL_FORCE, toolDevice->m_contact.getNumCandidates(), -1,
+                toolDevice->m_force.length());
         }
+    }
 
-        // integrate dynamics
-        defWorld->updateDynamics(time);
+    // pull the point grabbed with the mouse
+    clothGrab.acquire();
+    cApplyClothGrab(clothGrab.getReadBuffer(), cloth, clothSolver, grabStiffness);
 
-        //// scale force
-        force.mul(deviceForceScale / workspaceScaleFactor);
+    a_timings.mark(C_PHASE_CONTACT);
 
-        //// send forces to haptic device
-        hapticDevice->setForce(force);
+    // integrate dynamics and resolve table contact, node positions are
+    // refreshed by the solver
+    clothSolver->step(a_time);
+    if (tableCollider.getNumContacts() > 0)
+    {
+        telemetry.record(hapticTick, C_TELEMETRY_TABLE_CONTACT, tableCollider.getNumContacts(),
+            tableCollider.getDeepestNode(), tableCollider.getMaxPenetration());
+    }
+
+    // move nodes that changed cell in the broad phase of each tool
+    for (int i = 0; i < numDevices; i++)
+    {
+        toolDevices[i]->m_contact.updateBroadPhase();
+    }
+
+    // publish positions to the graphics thread
+    hapticTick++;
+    cClothSnapshot& snapshot = clothSnapshot.getWriteBuffer();
+    snapshot.m_tick = hapticTick;
+    cloth->writeSnapshot(snapshot);
+    clothSnapshot.publish();
+
+    a_timings.mark(C_PHASE_DYNAMICS);
+}
+
+//------------------------------------------------------------------------------
+
+void updatePhysics(void)
+{
+    // initialize precision clock
+    cPrecisionClock clock;
+    clock.reset();
+
+    // main cloth simulation loop, runs as fast as the solver allows
+    while (simulationRunning || !simulationFinished)
+    {
+        // stop clock, the fixed step accumulator keeps time beyond 1 ms
+        double interval = clock.stop();
+        double time = fixedStepping ? interval : cMin(0.001, interval);
+
+        // restart clock
+        clock.start(true);
+
+        physicsTimings.beginTick();
+
+        // latest tool poses from the haptics threads
+        for (int i = 0; i < numDevices; i++)
+        {
+            toolDevices[i]->m_pose.acquire();
+            toolDevices[i]->m_tool = toolDevices[i]->m_pose.getReadBuffer();
+        }
+
+        physicsTimings.mark(C_PHASE_DEVICE_READ);
+
+        // advance the cloth, the proxies render the force only
+        int numSteps = 1;
+        if (fixedStepping)
+        {
+            // whole fixed steps due since the last loop, then blend the
+            // forces of the last two steps by the time left in the accumulator
+            numSteps = fixedStep.advance(time);
+            physicsTimings.include(C_PHASE_CONTACT);
+            physicsTimings.include(C_PHASE_DYNAMICS);
+            for (int s = 0; s < numSteps; s++)
+            {
+                for (int k = 0; k < fixedStep.getNumSubsteps(); k++)
+                {
+                    stepPhysics(fixedStep.getSubstep(), physicsTimings);
+                }
+                for (int i = 0; i < numDevices; i++)
+                {
+                    toolDevices[i]->m_previousForce = toolDevices[i]->m_currentForce;
+                    toolDevices[i]->m_currentForce = toolDevices[i]->m_force;
+                }
+            }
+        }
+        else
+        {
+            stepPhysics(time, physicsTimings);
+        }
+
+        // linearize the contact around the current position of each tool,
+        // stiffer when more nodes push back, bounded by what its device can
+        // render
+        double alpha = fixedStep.getAlpha();
+        for (int i = 0; i < numDevices; i++)
+        {
+            cToolDevice* toolDevice = toolDevices[i];
+            cVector3d force = fixedStepping ?
+                (1.0 - alpha) * toolDevice->m_previousForce + alpha * toolDevice->m_currentForce : toolDevice->m_force;
+            double proxyStiffness = cMin(stiffness * (double)cMax(1, toolDevice->m_contact.countContacts()),
+                toolDevice->m_maxProxyStiffness);
+            cContactProxy& proxy = toolDevice->m_proxy.getWriteBuffer();
+            cUpdateContactProxy(proxy, toolDevice->m_tool.m_pos, force, proxyStiffness);
+            proxy.m_tick = hapticTick;
+            toolDevice->m_proxy.publish();
+        }
+
+        physicsTimings.mark(C_PHASE_SET_FORCE);
 
-        /* triangle objects */
         // compute global reference frames for each object
         world->computeGlobalPositions(true);
 
-        // update position and orientation of tool
-        //tool->updateFromDevice();
+        physicsTimings.mark(C_PHASE_GLOBAL_POSITIONS);
+        physicsTimings.endTick();
+
+        // signal frequency counter, once per physics step
+        freqCounterPhysics.signal(numSteps);
+    }
+
+    // exit physics thread
+    physicsFinished = true;
+}
+
+//------------------------------------------------------------------------------
 
-        //// compute interaction forces
-        //tool->computeInteractionForces();
+void updateHapticsProxy(void* a_arg)
+{
+    // device of this thread, on its own core when possible
+    cToolDevice* toolDevice = (cToolDevice*)a_arg;
+    if ((toolDevice->m_core >= 0) && !cPinCurrentThread(toolDevice->m_core))
+    {
+        toolDevice->m_core = -1;
+    }
+    cHapticTimings& timings = toolDevice->m_timings;
+
+    // initialize precision clock
+    cPrecisionClock clock;
+    clock.reset();
+    clock.start(true);
+
+    const double period = 1.0 / hapticRate;
+    double nextTick = 0.0;
+    double lastTick = 0.0;
+    bool firstTick = true;
+    cContactProxy proxy;
+    proxy.m_active = false;
+
+    // main haptic loop, ticks at a fixed rate
+    while (simulationRunning)
+    {
+        // wait for the next tick, the loop is too short for the scheduler
+        double now = clock.getCurrentTimeSeconds();
+        while (now < nextTick)
+        {
+            now = clock.getCurrentTimeSeconds();
+        }
+
+        // do not try to catch up after a stall
+        nextTick = cMax(nextTick + period, now);
+
+        // record time between two ticks
+        double interval = firstTick ? 0.0 : now - lastTick;
+        if (!firstTick)
+        {
+            timings.getHistogram(C_PHASE_INTERVAL).record((unsigned long long)(1e9 * interval));
+        }
+        firstTick = false;
+        lastTick = now;
+
+        timings.beginTick();
+
+        // read position and orientation from haptic device, and hand them
+        // over to the physics thread
+        cVector3d devicePos;
+        cToolPose& tool = toolDevice->m_pose.getWriteBuffer();
+        toolDevice->readPose(tool, devicePos);
+        cVector3d pos = tool.m_pos;
+        cMatrix3d rot = tool.m_rot;
+        toolDevice->m_pose.publish();
+
+        timings.mark(C_PHASE_DEVICE_READ);
+
+        // render the latest contact proxy, keep the previous one until a new
+        // one is published
+        if (toolDevice->m_proxy.acquire())
+        {
+            proxy = toolDevice->m_proxy.getReadBuffer();
+        }
+        cVector3d force = cComputeProxyForce(proxy, pos);
+
+        timings.mark(C_PHASE_CONTACT);
+
+        //// scale force
+        force.mul(deviceForceScale / toolDevice->m_workspaceScaleFactor);
 
         //// send forces to haptic device
-        //tool->applyToDevice();
+        toolDevice->m_device->setForce(force);
 
+        // log the tick, sessions are only recorded with a single device
+        sessionRecorder.record(interval, devicePos, rot, force, cVector3d(0.0, 0.0, 0.0));
+
+        timings.mark(C_PHASE_SET_FORCE);
+        timings.endTick();
 
         // signal frequency counter
-        freqCounterHaptics.signal(1);
+        toolDevice->m_freqCounter.signal(1);
     }
 
-    // exit haptics thread
-    simulationFinished = true;
+    // exit haptics thread, the last one to leave ends the simulation
+    if (--numHapticsThreads == 0)
+    {
+        simulationFinished = true;
+    }
 }
 
-void clothTableCollision() {
+//------------------------------------------------------------------------------
+
+// value at fraction a_p of sorted samples
+static double percentile(const std::vector<double>& a_sorted, double a_p)
+{
+    size_t i = (size_t)(a_p * (double)(a_sorted.size() - 1) + 0.5);
+    return (a_sorted[i]);
 }
 
-//---------------------------------------------------------------------------
+//------------------------------------------------------------------------------
 
-cVector3d computeForce(const cVector3d& a_cursor,
-    double a_cursorRadius,
-    const cVector3d& a_spherePos,
-    double a_radius,
-    double a_stiffness)
+void runHeadless(double a_duration)
 {
-    // compute the reaction forces between the tool and the ith sphere.
-    cVector3d force;
-    force.zero();
-    cVector3d vSphereCursor = a_cursor - a_spherePos;
+    // a replay runs the recorded ticks with their time steps
+    const double timeStep = 0.001;
+    const cSessionRecord* records = replaySession.getRecords();
+    int numTicks = (replayDevice != NULL) ? (int)replaySession.getNumRecords() : cMax(1, (int)(a_duration / timeStep + 0.5));
+    if (numTicks == 0)
+    {
+        std::cout << "session " << replayFile << " has no ticks" << std::endl;
+        return;
+    }
+    std::vector<double> latency(numTicks);
+
+    // largest difference from the recorded forces and torques, and first tick
+    // that differs
+    double maxForceError = 0.0;
+    double maxTorqueError = 0.0;
+    int firstDivergence = -1;
+
+    std::cout << ((replayDevice != NULL) ? "replay run: " : "headless run: ") << numTicks << " ticks, grid " << cloth->m_params.numX << "x" << cloth->m_params.numY << ", solver " << clothSolver->getName() << std::endl;
+
+    simulationRunning = true;
+    simulationFinished = false;
+
+    // run as fast as possible with a fixed simulated time step
+    cPrecisionClock runClock;
+    cPrecisionClock tickClock;
+    runClock.start(true);
+    for (int i = 0; i < numTicks; i++)
+    {
+        double dt = (replayDevice != NULL) ? records[i].m_dt : timeStep;
+        tickClock.start(true);
+        stepHaptics(dt);
+        latency[i] = tickClock.stop();
+
+        if (replayDevice != NULL)
+        {
+            // compare with the force and torque sent during the recording
+            cVector3d recordedForce(records[i].m_force[0], records[i].m_force[1], records[i].m_force[2]);
+            cVector3d recordedTorque(records[i].m_torque[0], records[i].m_torque[1], records[i].m_torque[2]);
+            double forceError = cDistance(replayDevice->getLastForce(), recordedForce);
+            double torqueError = cDistance(replayDevice->getLastTorque(), recordedTorque);
+            if (((forceError > 0.0) || (torqueError > 0.0)) && (firstDivergence < 0))
+            {
+                firstDivergence = i;
+            }
+            maxForceError = cMax(maxForceError, forceError);
+            maxTorqueError = cMax(maxTorqueError, torqueError);
+            replayDevice->advance();
+        }
+        else
+        {
+            scriptedDevice->advance(timeStep);
+        }
+    }
+    double elapsed = runClock.stop();
+
+    simulationRunning = false;
+    simulationFinished = true;
+
+    // tick rate and latency percentiles
+    double sum = 0.0;
+    for (int i = 0; i < numTicks; i++) { sum += latency[i]; }
+    std::sort(latency.begin(), latency.end());
+
+    std::cout << "tick rate:  " << cStr(numTicks / elapsed, 0) << " Hz" << std::endl;
+    std::cout << "latency us: mean " << cStr(1e6 * sum / numTicks, 1) <<
+        "  p50 " << cStr(1e6 * percentile(latency, 0.5), 1) <<
+        "  p90 " << cStr(1e6 * percentile(latency, 0.9), 1) <<
+        "  p99 " << cStr(1e6 * percentile(latency, 0.99), 1) <<
+        "  p99.9 " << cStr(1e6 * percentile(latency, 0.999), 1) <<
+        "  max " << cStr(1e6 * latency.back(), 1) << std::endl;
+    for (int i = 0; i < C_NUM_HAPTIC_PHASES; i++)
+    {
+        if (toolDevices[0]->m_timings.getHistogram(i).getCount() > 0)
+        {
+            std::cout << "  " << cHapticTimings::getPhaseName(i) << ": " << toolDevices[0]->m_timings.getHistogram(i).getSummary() << std::endl;
+        }
+    }
+    if (selfCollision)
+    {
+        for (int i = 0; i < C_NUM_SELF_PHASES; i++)
+        {
+            std::cout << "  " << cSelfCollider::getPhaseName(i) << ": " << selfCollider.getHistogram(i).getSummary() << std::endl;
+        }
+        std::cout << "  self pairs: " << selfCollider.getNumPointTrianglePairs() << " node-triangle, " <<
+            selfCollider.getNumEdgeEdgePairs() << " edge-edge" << std::endl;
+    }
+
+    // final cloth state
+    cVector3d center(0.0, 0.0, 0.0);
+    cVector3d lower(cloth->m_px[0], cloth->m_py[0], cloth->m_pz[0]);
+    cVector3d upper = lower;
+    int numNodes = cloth->getNumNodes();
+    for (int i = 0; i < numNodes; i++)
+    {
+        cVector3d p(cloth->m_px[i], cloth->m_py[i], cloth->m_pz[i]);
+        center.add(p);
+        for (int k = 0; k < 3; k++)
+        {
+            lower(k) = cMin(lower(k), p(k));
+            upper(k) = cMax(upper(k), p(k));
+        }
+    }
+    center.mul(1.0 / numNodes);
+
+    std::cout << "cloth center: " << center.str(4) << std::endl;
+    std::cout << "cloth bounds: " << lower.str(4) << " / " << upper.str(4) << std::endl;
+    if (replayDevice != NULL)
+    {
+        std::cout << "last force:   " << replayDevice->getLastForce().str(4) << std::endl;
+        std::cout << "last torque:  " << replayDevice->getLastTorque().str(4) << std::endl;
+        if (firstDivergence < 0)
+        {
+            std::cout << "replay:       forces and torques match the recording" << std::endl;
+        }
+        else
+        {
+            std::cout << "replay:       forces differ from tick " << firstDivergence << ", max error " << cStr(maxForceError, 6) << " N, " <<
+                cStr(maxTorqueError, 6) << " Nm" << std::endl;
+        }
+    }
+    else
+    {
+        std::cout << "last force:   " << scriptedDevice->getLastForce().str(4) << std::endl;
+    }
+    if (meshCollider.getNumObstacles() > 0)
+    {
+        std::cout << "obstacles:    " << meshCollider.getNumContacts() << " nodes in contact of " <<
+            meshCollider.getNumSampled() << " sampled" << std::endl;
+    }
+    if (fixedStepping)
+    {
+        std::cout << "fixed step:   " << cStr(1000.0 * fixedStep.getStep(), 3) << " ms x " << fixedStep.getNumSubsteps() <<
+            " substeps, dropped " << cStr(1000.0 * fixedStep.getDroppedTime(), 1) << " ms" << std::endl;
+    }
+}
+
+//------------------------------------------------------------------------------
 
-    // check if both objects are intersecting
-    if (vSphereCursor.length() < 0.0000001)
+void settleCloth(double a_duration, const string& a_filename, unsigned long long a_key)
+{
+    const double timeStep = 0.001;
+    int numSteps = cMax(1, (int)(a_duration / timeStep + 0.5));
+
+    std::cout << "settling cloth: " << numSteps << " steps, grid " << cloth->m_params.numX << "x" << cloth->m_params.numY << ", solver " << clothSolver->getName() << std::endl;
+
+    // gravity, table and obstacles only
+    cPrecisionClock clock;
+    clock.start(true);
+    for (int i = 0; i < numSteps; i++)
+    {
+        clothSolver->clearExternalForces();
+        clothSolver->step(timeStep);
+    }
+    double elapsed = clock.stop();
+
+    // fastest node left, a cloth at rest is below a few mm/s
+    int numNodes = cloth->getNumNodes();
+    std::vector<double> vx(numNodes), vy(numNodes), vz(numNodes);
+    clothSolver->getVelocities(&vx[0], &vy[0], &vz[0]);
+    double maxSpeed = 0.0;
+    for (int i = 0; i < numNodes; i++)
     {
-        return (force);
+        maxSpeed = cMax(maxSpeed, sqrt(vx[i] * vx[i] + vy[i] * vy[i] + vz[i] * vz[i]));
     }
 
-    if (vSphereCursor.length() > (a_cursorRadius + a_radius))
+    std::cout << "settled in " << cStr(elapsed, 2) << " s, fastest node " << cStr(1000.0 * maxSpeed, 2) << " mm/s" << std::endl;
+    if (cSaveClothState(a_filename, cloth, clothSolver, a_key, numSteps * timeStep))
     {
-        return (force);
+        std::cout << "saved " << a_filename << std::endl;
     }
+    else
+    {
+        std::cout << "failed to save " << a_filename << std::endl;
+    }
+}
 
-    // compute penetration distance between tool and surface of sphere
-    double penetrationDistance = (a_cursorRadius + a_radius) - vSphereCursor.length();
-    cVector3d forceDirection = cNormalize(vSphereCursor);
-    force = cMul(penetrationDistance * a_stiffness, forceDirection);
+//------------------------------------------------------------------------------
 
-    // return result
-    return (force);
+// ray from the camera through window point (a_x, a_y)
+static void cameraRay(double a_x, double a_y, cVector3d& a_origin, cVector3d& a_dir)
+{
+    cVector3d forward = camera->getLookVector();
+    cVector3d right = camera->getRightVector();
+    cVector3d up = camera->getUpVector();
+
+    // the field of view angle is vertical
+    double tanHalfAngle = tan(0.5 * cDegToRad(camera->getFieldViewAngleDeg()));
+    double aspect = (double)windowWidth / (double)cMax(1, windowHeight);
+    double sx = (2.0 * a_x / cMax(1, windowWidth) - 1.0) * tanHalfAngle * aspect;
+    double sy = (1.0 - 2.0 * a_y / cMax(1, windowHeight)) * tanHalfAngle;
+
+    a_origin = camera->getGlobalPos();
+    a_dir = cNormalize(forward + sx * right + sy * up);
 }
 
 //------------------------------------------------------------------------------
 
-void mouseButtonCallback(GLFWwindow* a_window, int a_button, int a_action, int a_mods)
+void mouseButtonCallback(GLFWwindow* a_window, int a_button, int a_action, int /*a_mods*/)
 {
-    double x, y;
-    glfwGetCursorPos(window, &x, &y);
-
-    if (a_button == GLFW_MOUSE_BUTTON_LEFT && a_action == GLFW_PRESS)
-    {
-        if (glfwGetKey(window, GLFW_KEY_LEFT_CONTROL) == GLFW_PRESS) {
-            std::cout << "l press" << std::endl;
-        }
-
-        oldX = x;
-        oldY = y;
-        int window_y = (windowHeight - y);
-        float norm_y = float(window_y) / float(windowHeight / 2.0);
-        int window_x = x;
-        float norm_x = float(window_x) / float(windowWidth / 2.0);
-        
-        float winZ = 0;
-        glReadPixels(x, windowHeight - y, 1, 1, GL_DEPTH_COMPONENT, GL_FLOAT, &winZ);
-        if (winZ == 1)
-            winZ = 0;
-        double objX = 0, objY = 0, objZ = 0;
-        gluUnProject(window_x, window_y, winZ, MV, P, viewport, &objX, &objY, &objZ);
-        glm::vec3 pt(objX, objY, objZ);
-        size_t i = 0;
-        for (i = 0; i < total_points; i++) {
-            if (glm::distance(X[i], pt) < 0.1) {
-                selected_index = i;
-                printf("Intersected at %d\n", i);
-                break;
-            }
+    if (a_button != GLFW_MOUSE_BUTTON_LEFT)
+    {
+        return;
+    }
+
+    if (a_action == GLFW_PRESS)
+    {
+        double x, y;
+        glfwGetCursorPos(a_window, &x, &y);
+        cVector3d origin, dir;
+        cameraRay(x, y, origin, dir);
+
+        // pick the cloth as drawn in the last frame
+        cClothRayHit hit;
+        if (!clothPicker.pick(cloth->m_indices, clothSnapshot.getReadBuffer().m_X, origin, dir, hit))
+        {
+            return;
         }
-    }   
-    if (a_action == GLFW_RELEASE) {
-        selected_index = -1;
-        glfwSetCursorPos(window, x, y);
+        // the cloth is drawn above the nodes, the target is kept at node height
+        grabDistance = hit.m_distance;
+        mouseGrab = cCreateClothGrab(cloth->m_indices, hit,
+            origin + grabDistance * dir - cVector3d(0.0, C_CLOTH_RENDER_OFFSET, 0.0));
+    }
+    else if ((a_action == GLFW_RELEASE) && mouseGrab.m_active)
+    {
+        mouseGrab.m_active = false;
+    }
+    else
+    {
+        return;
+    }
+
+    clothGrab.getWriteBuffer() = mouseGrab;
+    clothGrab.publish();
+}
+
+//------------------------------------------------------------------------------
+
+void cursorPosCallback(GLFWwindow* /*a_window*/, double a_x, double a_y)
+{
+    if (!mouseGrab.m_active)
+    {
+        return;
     }
+
+    // the grabbed point follows the mouse at constant distance from the camera
+    cVector3d origin, dir;
+    cameraRay(a_x, a_y, origin, dir);
+    mouseGrab.m_target = origin + grabDistance * dir - cVector3d(0.0, C_CLOTH_RENDER_OFFSET, 0.0);
+
+    clothGrab.getWriteBuffer() = mouseGrab;
+    clothGrab.publish();
 }
 
@@ -0,0 +1,219 @@
+//------------------------------------------------------------------------------
+#include "mappedFile.h"
+//------------------------------------------------------------------------------
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+//------------------------------------------------------------------------------
+
+cMappedFile::cMappedFile()
+{
+    m_data = NULL;
+    m_size = 0;
+    m_writable = false;
+#if defined(_WIN32)
+    m_file = INVALID_HANDLE_VALUE;
+    m_mapping = NULL;
+#else
+    m_file = -1;
+#endif
+}
+
+//------------------------------------------------------------------------------
+
+cMappedFile::~cMappedFile()
+{
+    close();
+}
+
+//------------------------------------------------------------------------------
+
+#if defined(_WIN32)
+
+bool cMappedFile::create(const std::string& a_filename, size_t a_size)
+{
+    close();
+
+    m_file = CreateFileA(a_filename.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, NULL,
+                         CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (m_file == INVALID_HANDLE_VALUE)
+    {
+        return (false);
+    }
+
+    unsigned long long size = a_size;
+    m_mapping = CreateFileMappingA(m_file, NULL, PAGE_READWRITE, (DWORD)(size >> 32), (DWORD)size, NULL);
+    m_data = (m_mapping != NULL) ? MapViewOfFile(m_mapping, FILE_MAP_WRITE, 0, 0, a_size) : NULL;
+    if (m_data == NULL)
+    {
+        close(0);
+        return (false);
+    }
+
+    m_size = a_size;
+    m_writable = true;
+    return (true);
+}
+
+//------------------------------------------------------------------------------
+
+bool cMappedFile::open(const std::string& a_filename)
+{
+    close();
+
+    m_file = CreateFileA(a_filename.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+                         OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (m_file == INVALID_HANDLE_VALUE)
+    {
+        return (false);
+    }
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(m_file, &size) || (size.QuadPart == 0))
+    {
+        close();
+        return (false);
+    }
+
+    m_mapping = CreateFileMappingA(m_file, NULL, PAGE_READONLY, 0, 0, NULL);
+    m_data = (m_mapping != NULL) ? MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0) : NULL;
+    if (m_data == NULL)
+    {
+        close();
+        return (false);
+    }
+
+    m_size = (size_t)size.QuadPart;
+    m_writable = false;
+    return (true);
+}
+
+//------------------------------------------------------------------------------
+
+bool cMappedFile::close(size_t a_size)
+{
+    bool cut = true;
+    if (m_data != NULL)
+    {
+        UnmapViewOfFile(m_data);
+    }
+    if (m_mapping != NULL)
+    {
+        CloseHandle(m_mapping);
+    }
+    if (m_file != INVALID_HANDLE_VALUE)
+    {
+        // cut the unused capacity once the file is no longer mapped
+        if (m_writable && (a_size < m_size))
+        {
+            LARGE_INTEGER size;
+            size.QuadPart = (LONGLONG)a_size;
+            cut = SetFilePointerEx(m_file, size, NULL, FILE_BEGIN) && SetEndOfFile(m_file);
+        }
+        CloseHandle(m_file);
+    }
+
+    m_data = NULL;
+    m_mapping = NULL;
+    m_file = INVALID_HANDLE_VALUE;
+    m_size = 0;
+    m_writable = false;
+    return (cut);
+}
+
+#else
+
+bool cMappedFile::create(const std::string& a_filename, size_t a_size)
+{
+    close();
+
+    m_file = ::open(a_filename.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (m_file < 0)
+    {
+        return (false);
+    }
+
+    // a truncated file is sparse, pages are only allocated once written
+    if (ftruncate(m_file, (off_t)a_size) != 0)
+    {
+        close(0);
+        return (false);
+    }
+
+    void* data = mmap(NULL, a_size, PROT_READ | PROT_WRITE, MAP_SHARED, m_file, 0);
+    if (data == MAP_FAILED)
+    {
+        close(0);
+        return (false);
+    }
+
+    m_data = data;
+    m_size = a_size;
+    m_writable = true;
+    return (true);
+}
+
+//------------------------------------------------------------------------------
+
+bool cMappedFile::open(const std::string& a_filename)
+{
+    close();
+
+    m_file = ::open(a_filename.c_str(), O_RDONLY);
+    if (m_file < 0)
+    {
+        return (false);
+    }
+
+    struct stat info;
+    if ((fstat(m_file, &info) != 0) || (info.st_size == 0))
+    {
+        close();
+        return (false);
+    }
+
+    void* data = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_SHARED, m_file, 0);
+    if (data == MAP_FAILED)
+    {
+        close();
+        return (false);
+    }
+
+    m_data = data;
+    m_size = (size_t)info.st_size;
+    m_writable = false;
+    return (true);
+}
+
+//------------------------------------------------------------------------------
+
+bool cMappedFile::close(size_t a_size)
+{
+    bool cut = true;
+    if (m_data != NULL)
+    {
+        munmap(m_data, m_size);
+    }
+    if (m_file >= 0)
+    {
+        // cut the unused capacity once the file is no longer mapped
+        if (m_writable && (a_size < m_size))
+        {
+            cut = (ftruncate(m_file, (off_t)a_size) == 0);
+        }
+        ::close(m_file);
+    }
+
+    m_data = NULL;
+    m_file = -1;
+    m_size = 0;
+    m_writable = false;
+    return (cut);
+}
+
+#endif
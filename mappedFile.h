@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+//------------------------------------------------------------------------------
+// DECLARED TYPES
+//------------------------------------------------------------------------------
+
+// file mapped in memory, either created for writing with a fixed capacity or
+// opened read-only. writes go straight to the page cache, so a log kept in a
+// mapping survives a crash of the process up to its last store.
+class cMappedFile
+{
+public:
+
+    // constructor
+    cMappedFile();
+
+    // destructor, closes the mapping
+    ~cMappedFile();
+
+    // create (or overwrite) a_filename with a_size bytes and map it for
+    // writing. on most file systems unused pages take no disk space.
+    bool create(const std::string& a_filename, size_t a_size);
+
+    // map an existing file read-only
+    bool open(const std::string& a_filename);
+
+    // unmap and close, a created file is cut to its first a_size bytes
+    // (the whole capacity by default). returns false if the file could not
+    // be cut, it then keeps its capacity.
+    bool close(size_t a_size = (size_t)-1);
+
+    // true while a file is mapped
+    bool isOpen() const { return (m_data != NULL); }
+
+    // mapped bytes
+    void* getData() const { return (m_data); }
+    size_t getSize() const { return (m_size); }
+
+protected:
+
+    // mapped memory and its size
+    void* m_data;
+    size_t m_size;
+
+    // true if the mapping is writable
+    bool m_writable;
+
+    // platform handles
+#if defined(_WIN32)
+    void* m_file;
+    void* m_mapping;
+#else
+    int m_file;
+#endif
+};
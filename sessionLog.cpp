@@ -0,0 +1,117 @@
+//------------------------------------------------------------------------------
+#include "sessionLog.h"
+//------------------------------------------------------------------------------
+#include <cstring>
+//------------------------------------------------------------------------------
+using namespace chai3d;
+//------------------------------------------------------------------------------
+
+// the records follow the header at a fixed, cache line aligned offset
+static const size_t C_SESSION_DATA_OFFSET = 256;
+
+static_assert(sizeof(cSessionHeader) <= C_SESSION_DATA_OFFSET, "session header too large");
+static_assert(sizeof(cSessionRecord) == 192, "unexpected session record size");
+
+//------------------------------------------------------------------------------
+
+cSessionRecorder::cSessionRecorder()
+{
+    m_header = NULL;
+    m_records = NULL;
+    m_capacity = 0;
+    m_numDropped = 0;
+}
+
+//------------------------------------------------------------------------------
+
+cSessionRecorder::~cSessionRecorder()
+{
+    stop();
+}
+
+//------------------------------------------------------------------------------
+
+bool cSessionRecorder::start(const std::string& a_filename, const cSessionHeader& a_header, unsigned long long a_capacity)
+{
+    if (m_header != NULL)
+    {
+        return (false);
+    }
+
+    size_t size = C_SESSION_DATA_OFFSET + (size_t)a_capacity * sizeof(cSessionRecord);
+    if (!m_file.create(a_filename, size))
+    {
+        return (false);
+    }
+
+    unsigned char* data = (unsigned char*)m_file.getData();
+    m_header = (cSessionHeader*)data;
+    m_records = (cSessionRecord*)(data + C_SESSION_DATA_OFFSET);
+    m_capacity = a_capacity;
+    m_numDropped = 0;
+
+    *m_header = a_header;
+    memcpy(m_header->m_magic, "CLOTHSES", 8);
+    m_header->m_version = C_SESSION_VERSION;
+    m_header->m_recordSize = sizeof(cSessionRecord);
+    m_header->m_numRecords = 0;
+
+    return (true);
+}
+
+//------------------------------------------------------------------------------
+
+bool cSessionRecorder::stop()
+{
+    if (m_header == NULL)
+    {
+        return (true);
+    }
+
+    size_t size = C_SESSION_DATA_OFFSET + (size_t)m_header->m_numRecords * sizeof(cSessionRecord);
+    m_header = NULL;
+    m_records = NULL;
+    return (m_file.close(size));
+}
+
+//------------------------------------------------------------------------------
+
+cSessionReader::cSessionReader()
+{
+    m_header = NULL;
+    m_records = NULL;
+    m_numRecords = 0;
+}
+
+//------------------------------------------------------------------------------
+
+bool cSessionReader::open(const std::string& a_filename)
+{
+    m_header = NULL;
+    m_records = NULL;
+    m_numRecords = 0;
+
+    if (!m_file.open(a_filename) || (m_file.getSize() < C_SESSION_DATA_OFFSET))
+    {
+        m_file.close();
+        return (false);
+    }
+
+    const unsigned char* data = (const unsigned char*)m_file.getData();
+    const cSessionHeader* header = (const cSessionHeader*)data;
+    if ((memcmp(header->m_magic, "CLOTHSES", 8) != 0) ||
+        (header->m_version != C_SESSION_VERSION) ||
+        (header->m_recordSize != sizeof(cSessionRecord)))
+    {
+        m_file.close();
+        return (false);
+    }
+
+    // trust the header only as far as the file goes
+    unsigned long long available = (m_file.getSize() - C_SESSION_DATA_OFFSET) / sizeof(cSessionRecord);
+    m_header = header;
+    m_records = (const cSessionRecord*)(data + C_SESSION_DATA_OFFSET);
+    m_numRecords = cMin(header->m_numRecords, available);
+
+    return (true);
+}
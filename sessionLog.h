@@ -0,0 +1,162 @@
+#pragma once
+
+#include "chai3d.h"
+#include "mappedFile.h"
+
+#include <string>
+
+//------------------------------------------------------------------------------
+// DECLARED TYPES
+//------------------------------------------------------------------------------
+
+// version of the session log layout
+const unsigned int C_SESSION_VERSION = 2;
+
+// header at the start of a session log, followed by the records. the number
+// of records is updated after every record, so a log cut short by a crash is
+// still valid up to its last tick.
+struct cSessionHeader
+{
+    // "CLOTHSES", layout version and size of one record
+    char m_magic[8];
+    unsigned int m_version;
+    unsigned int m_recordSize;
+
+    // number of records in the log
+    unsigned long long m_numRecords;
+
+    // cloth grid and solver the session was recorded with
+    int m_gridX;
+    int m_gridY;
+    char m_solver[16];
+
+    // fixed stepping (step [s], substeps and catch-up steps, zero if disabled)
+    double m_fixedStep;
+    int m_fixedSubsteps;
+    int m_fixedMaxSteps;
+
+    // nonzero if recorded by the haptics thread of the multi-rate mode
+    int m_multiRate;
+
+    // number of devices driving the cloth, only the first one is logged
+    int m_numDevices;
+
+    // device specifications, they set the workspace and force scales
+    double m_workspaceRadius;
+    double m_maxLinearForce;
+    double m_maxLinearStiffness;
+
+    // command line of the recording, for the options not stored above
+    char m_options[160];
+};
+
+// one haptic tick: time step [s], device position and orientation (row
+// major), force and torque sent to the device, all in device coordinates
+struct cSessionRecord
+{
+    unsigned long long m_tick;
+    double m_dt;
+    double m_pos[3];
+    double m_rot[9];
+    double m_force[3];
+    double m_torque[3];
+    double m_reserved[4];
+};
+
+//------------------------------------------------------------------------------
+
+// appends haptic ticks to a memory-mapped session log. the whole capacity is
+// mapped up front, so appending is a plain store into the page cache.
+class cSessionRecorder
+{
+public:
+
+    // constructor
+    cSessionRecorder();
+
+    // destructor, closes the log
+    ~cSessionRecorder();
+
+    // create a_filename with room for a_capacity records
+    bool start(const std::string& a_filename, const cSessionHeader& a_header, unsigned long long a_capacity);
+
+    // cut the log to the records written and close it, returns false if the
+    // log could not be cut (it is still valid, the header holds the count)
+    bool stop();
+
+    // true if the recorder is running
+    bool isEnabled() const { return (m_header != NULL); }
+
+    // append a tick (haptics thread), counts a drop once the log is full
+    void record(double a_dt, const chai3d::cVector3d& a_pos, const chai3d::cMatrix3d& a_rot,
+        const chai3d::cVector3d& a_force, const chai3d::cVector3d& a_torque)
+    {
+        if (m_header == NULL) { return; }
+        unsigned long long n = m_header->m_numRecords;
+        if (n >= m_capacity)
+        {
+            m_numDropped++;
+            return;
+        }
+        cSessionRecord& record = m_records[n];
+        record.m_tick = n;
+        record.m_dt = a_dt;
+        for (int k = 0; k < 3; k++)
+        {
+            record.m_pos[k] = a_pos(k);
+            record.m_force[k] = a_force(k);
+            record.m_torque[k] = a_torque(k);
+            for (int j = 0; j < 3; j++)
+            {
+                record.m_rot[3 * k + j] = a_rot(k, j);
+            }
+        }
+        m_header->m_numRecords = n + 1;
+    }
+
+    // number of records written and dropped
+    unsigned long long getNumRecords() const { return ((m_header != NULL) ? m_header->m_numRecords : 0); }
+    unsigned long long getNumDropped() const { return (m_numDropped); }
+
+protected:
+
+    // mapped log
+    cMappedFile m_file;
+    cSessionHeader* m_header;
+    cSessionRecord* m_records;
+
+    // most records the log can hold
+    unsigned long long m_capacity;
+
+    // records lost because the log was full
+    unsigned long long m_numDropped;
+};
+
+//------------------------------------------------------------------------------
+
+// read-only view of a session log
+class cSessionReader
+{
+public:
+
+    // constructor
+    cSessionReader();
+
+    // map a_filename, returns false if it is not a valid session log
+    bool open(const std::string& a_filename);
+
+    // header and records of the log
+    const cSessionHeader& getHeader() const { return (*m_header); }
+    const cSessionRecord* getRecords() const { return (m_records); }
+    unsigned long long getNumRecords() const { return (m_numRecords); }
+
+protected:
+
+    // mapped log
+    cMappedFile m_file;
+    const cSessionHeader* m_header;
+    const cSessionRecord* m_records;
+
+    // records present in the file
+    unsigned long long m_numRecords;
+};
@@ -0,0 +1,104 @@
+//------------------------------------------------------------------------------
+#include "spatialHash.h"
+//------------------------------------------------------------------------------
+using namespace chai3d;
+//------------------------------------------------------------------------------
+
+cSpatialHash::cSpatialHash()
+{
+    m_cellSize = 1.0;
+    m_invCellSize = 1.0;
+    m_mask = 0;
+    m_numCandidates = 0;
+}
+
+//------------------------------------------------------------------------------
+
+void cSpatialHash::setup(int a_numPoints, double a_cellSize)
+{
+    m_cellSize = a_cellSize;
+    m_invCellSize = 1.0 / a_cellSize;
+
+    // use a power of two table with about two buckets per point
+    int size = 1;
+    while (size < 2 * a_numPoints) { size <<= 1; }
+    m_mask = size - 1;
+
+    m_buckets.clear();
+    m_buckets.resize(size);
+
+    cPointCell unassigned = { 0, 0, 0, -1, -1 };
+    m_cells.assign(a_numPoints, unassigned);
+
+    m_numCandidates = 0;
+}
+
+//------------------------------------------------------------------------------
+
+bool cSpatialHash::update(int a_index, const cVector3d& a_pos)
+{
+    cPointCell& cell = m_cells[a_index];
+    int x = cellCoord(a_pos.x());
+    int y = cellCoord(a_pos.y());
+    int z = cellCoord(a_pos.z());
+
+    // point did not leave its cell
+    if ((cell.m_bucket >= 0) && (cell.m_x == x) && (cell.m_y == y) && (cell.m_z == z))
+    {
+        return (false);
+    }
+
+    // remove point from its old bucket by swapping in the last entry
+    if (cell.m_bucket >= 0)
+    {
+        std::vector<int>& points = m_buckets[cell.m_bucket];
+        int last = points.back();
+        points[cell.m_slot] = last;
+        m_cells[last].m_slot = cell.m_slot;
+        points.pop_back();
+    }
+
+    // insert point in its new bucket
+    cell.m_x = x;
+    cell.m_y = y;
+    cell.m_z = z;
+    cell.m_bucket = bucket(x, y, z);
+    cell.m_slot = (int)m_buckets[cell.m_bucket].size();
+    m_buckets[cell.m_bucket].push_back(a_index);
+
+    return (true);
+}
+
+//------------------------------------------------------------------------------
+
+int cSpatialHash::query(const cVector3d& a_min, const cVector3d& a_max, std::vector<int>& a_result)
+{
+    a_result.clear();
+
+    int x0 = cellCoord(a_min.x()), x1 = cellCoord(a_max.x());
+    int y0 = cellCoord(a_min.y()), y1 = cellCoord(a_max.y());
+    int z0 = cellCoord(a_min.z()), z1 = cellCoord(a_max.z());
+
+    for (int z = z0; z <= z1; z++)
+    {
+        for (int y = y0; y <= y1; y++)
+        {
+            for (int x = x0; x <= x1; x++)
+            {
+                const std::vector<int>& points = m_buckets[bucket(x, y, z)];
+                for (size_t i = 0; i < points.size(); i++)
+                {
+                    // skip points of other cells sharing the same bucket
+                    const cPointCell& cell = m_cells[points[i]];
+                    if ((cell.m_x == x) && (cell.m_y == y) && (cell.m_z == z))
+                    {
+                        a_result.push_back(points[i]);
+                    }
+                }
+            }
+        }
+    }
+
+    m_numCandidates = (int)a_result.size();
+    return (m_numCandidates);
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "chai3d.h"
+
+#include <vector>
+
+//------------------------------------------------------------------------------
+// DECLARED TYPES
+//------------------------------------------------------------------------------
+
+// uniform grid over a fixed set of points, stored in a hash table of cells.
+// points are moved between cells incrementally, only when their cell changes.
+class cSpatialHash
+{
+public:
+
+    // constructor
+    cSpatialHash();
+
+    // allocate the table for a_numPoints points, all points start unassigned
+    void setup(int a_numPoints, double a_cellSize);
+
+    // move point a_index to position a_pos, returns true if it changed cell
+    bool update(int a_index, const chai3d::cVector3d& a_pos);
+
+    // collect all points whose cell overlaps the box [a_min, a_max]
+    int query(const chai3d::cVector3d& a_min, const chai3d::cVector3d& a_max, std::vector<int>& a_result);
+
+    // number of candidates returned by the last query
+    int getNumCandidates() const { return m_numCandidates; }
+
+    // edge length of a cell
+    double getCellSize() const { return m_cellSize; }
+
+protected:
+
+    // cell coordinate of a scalar position
+    int cellCoord(double a_value) const { return (int)floor(a_value * m_invCellSize); }
+
+    // bucket of a cell
+    int bucket(int a_x, int a_y, int a_z) const
+    {
+        return (int)(((unsigned int)a_x * 73856093u) ^ ((unsigned int)a_y * 19349663u) ^ ((unsigned int)a_z * 83492791u)) & m_mask;
+    }
+
+protected:
+
+    // per point cell assignment
+    struct cPointCell
+    {
+        int m_x, m_y, m_z;
+        int m_bucket;
+        int m_slot;
+    };
+
+    // edge length of a cell
+    double m_cellSize;
+    double m_invCellSize;
+
+    // table size minus one (table size is a power of two)
+    int m_mask;
+
+    // points stored in each bucket
+    std::vector<std::vector<int> > m_buckets;
+
+    // cell of each point
+    std::vector<cPointCell> m_cells;
+
+    // number of candidates returned by the last query
+    int m_numCandidates;
+};
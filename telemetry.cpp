@@ -0,0 +1,113 @@
+//------------------------------------------------------------------------------
+#include "telemetry.h"
+//------------------------------------------------------------------------------
+using namespace chai3d;
+//------------------------------------------------------------------------------
+
+cTelemetryRing::cTelemetryRing(int a_capacity)
+{
+    unsigned int size = 1;
+    while (size < (unsigned int)a_capacity) { size <<= 1; }
+    m_events.resize(size);
+    m_mask = size - 1;
+    m_head.store(0);
+    m_tail.store(0);
+    m_numDropped.store(0);
+}
+
+//------------------------------------------------------------------------------
+
+cTelemetryLogger::cTelemetryLogger(int a_capacity) : m_ring(a_capacity)
+{
+    m_file = NULL;
+    m_thread = NULL;
+    m_running = false;
+    m_finished = true;
+}
+
+//------------------------------------------------------------------------------
+
+cTelemetryLogger::~cTelemetryLogger()
+{
+    stop();
+}
+
+//------------------------------------------------------------------------------
+
+bool cTelemetryLogger::start(const std::string& a_filename)
+{
+    if (m_running)
+    {
+        return (false);
+    }
+
+    m_file = fopen(a_filename.c_str(), "w");
+    if (m_file == NULL)
+    {
+        return (false);
+    }
+    fprintf(m_file, "tick,type,count,node,value\n");
+
+    m_running = true;
+    m_finished = false;
+    m_thread = new cThread();
+    m_thread->start(consumer, CTHREAD_PRIORITY_GRAPHICS, this);
+
+    return (true);
+}
+
+//------------------------------------------------------------------------------
+
+void cTelemetryLogger::stop()
+{
+    if (!m_running)
+    {
+        return;
+    }
+
+    // wait for the consumer thread to write pending events and exit
+    m_running = false;
+    while (!m_finished) { cSleepMs(10); }
+    delete m_thread;
+    m_thread = NULL;
+
+    if (m_ring.getNumDropped() > 0)
+    {
+        fprintf(m_file, "# %u events dropped\n", m_ring.getNumDropped());
+    }
+    fclose(m_file);
+    m_file = NULL;
+}
+
+//------------------------------------------------------------------------------
+
+void cTelemetryLogger::consumer(void* a_logger)
+{
+    cTelemetryLogger* logger = (cTelemetryLogger*)a_logger;
+
+    while (logger->m_running)
+    {
+        if (logger->drain() == 0)
+        {
+            cSleepMs(10);
+        }
+    }
+
+    // write events recorded before stop()
+    logger->drain();
+    logger->m_finished = true;
+}
+
+//------------------------------------------------------------------------------
+
+int cTelemetryLogger::drain()
+{
+    int count = 0;
+    cTelemetryEvent event;
+    while (m_ring.pop(event))
+    {
+        fprintf(m_file, "%llu,%d,%d,%d,%g\n", event.m_tick, event.m_type, event.m_count, event.m_node, event.m_value);
+        count++;
+    }
+    return (count);
+}
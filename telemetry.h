@@ -0,0 +1,140 @@
+#pragma once
+
+#include "chai3d.h"
+
+#include <atomic>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+//------------------------------------------------------------------------------
+// DECLARED TYPES
+//------------------------------------------------------------------------------
+
+// kind of telemetry event
+enum cTelemetryEventType
+{
+    // nodes projected onto the table: count, deepest node and its penetration [m]
+    C_TELEMETRY_TABLE_CONTACT = 0,
+
+    // tool in contact: number of candidate nodes and force magnitude [N]
+    C_TELEMETRY_TOOL_FORCE = 1
+};
+
+// fixed size event recorded by the haptics thread
+struct cTelemetryEvent
+{
+    unsigned long long m_tick;
+    int m_type;
+    int m_count;
+    int m_node;
+    float m_value;
+};
+
+//------------------------------------------------------------------------------
+
+// lock-free single-producer/single-consumer ring buffer of events
+class cTelemetryRing
+{
+public:
+
+    // constructor, capacity is rounded up to a power of two
+    cTelemetryRing(int a_capacity);
+
+    // producer: append an event, returns false (and counts a drop) when full
+    bool push(const cTelemetryEvent& a_event)
+    {
+        unsigned int head = m_head.load(std::memory_order_relaxed);
+        if (head - m_tail.load(std::memory_order_acquire) > m_mask)
+        {
+            m_numDropped.fetch_add(1, std::memory_order_relaxed);
+            return (false);
+        }
+        m_events[head & m_mask] = a_event;
+        m_head.store(head + 1, std::memory_order_release);
+        return (true);
+    }
+
+    // consumer: remove the oldest event, returns false when empty
+    bool pop(cTelemetryEvent& a_event)
+    {
+        unsigned int tail = m_tail.load(std::memory_order_relaxed);
+        if (tail == m_head.load(std::memory_order_acquire))
+        {
+            return (false);
+        }
+        a_event = m_events[tail & m_mask];
+        m_tail.store(tail + 1, std::memory_order_release);
+        return (true);
+    }
+
+    // number of events lost because the ring was full
+    unsigned int getNumDropped() const { return m_numDropped.load(std::memory_order_relaxed); }
+
+protected:
+
+    // event storage
+    std::vector<cTelemetryEvent> m_events;
+
+    // capacity minus one
+    unsigned int m_mask;
+
+    // write and read counters, producer and consumer are on separate cache lines
+    alignas(64) std::atomic<unsigned int> m_head;
+    alignas(64) std::atomic<unsigned int> m_tail;
+    alignas(64) std::atomic<unsigned int> m_numDropped;
+};
+
+//------------------------------------------------------------------------------
+
+// drains a telemetry ring to a CSV file from a low priority thread
+class cTelemetryLogger
+{
+public:
+
+    // constructor
+    cTelemetryLogger(int a_capacity = 65536);
+
+    // destructor
+    ~cTelemetryLogger();
+
+    // open the log file and start the consumer thread
+    bool start(const std::string& a_filename);
+
+    // stop the consumer thread, write remaining events and close the file
+    void stop();
+
+    // true if the logger is running
+    bool isEnabled() const { return m_running; }
+
+    // record an event (haptics thread)
+    void record(unsigned long long a_tick, int a_type, int a_count, int a_node, double a_value)
+    {
+        if (!m_running) { return; }
+        cTelemetryEvent event = { a_tick, a_type, a_count, a_node, (float)a_value };
+        m_ring.push(event);
+    }
+
+protected:
+
+    // consumer thread entry point
+    static void consumer(void* a_logger);
+
+    // write all pending events, returns number of events written
+    int drain();
+
+protected:
+
+    // event ring
+    cTelemetryRing m_ring;
+
+    // output file
+    FILE* m_file;
+
+    // consumer thread
+    chai3d::cThread* m_thread;
+
+    // consumer state
+    volatile bool m_running;
+    volatile bool m_finished;
+};
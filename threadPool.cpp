@@ -0,0 +1,201 @@
+//------------------------------------------------------------------------------
+#include "threadPool.h"
+//------------------------------------------------------------------------------
+#include <algorithm>
+#if defined(_WIN32)
+#include <windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+//------------------------------------------------------------------------------
+
+// number of polls of an idle worker before it goes to sleep, solver loops are
+// issued back to back and a wake up through the kernel costs more than a step
+static const int C_SPIN_COUNT = 200000;
+
+//------------------------------------------------------------------------------
+
+cThreadPool::cThreadPool(int a_numThreads)
+{
+    int numThreads = std::max(1, a_numThreads);
+
+    m_function = NULL;
+    m_numPending = 0;
+    m_generation = 0;
+    m_quit = false;
+
+    for (int i = 0; i < numThreads; i++)
+    {
+        m_queues.push_back(new cQueue());
+    }
+    for (int i = 1; i < numThreads; i++)
+    {
+        m_threads.push_back(std::thread(&cThreadPool::workerLoop, this, i));
+    }
+}
+
+//------------------------------------------------------------------------------
+
+cThreadPool::~cThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_wakeMutex);
+        m_quit = true;
+        m_generation++;
+    }
+    m_wake.notify_all();
+
+    for (size_t i = 0; i < m_threads.size(); i++)
+    {
+        m_threads[i].join();
+    }
+    for (size_t i = 0; i < m_queues.size(); i++)
+    {
+        delete m_queues[i];
+    }
+}
+
+//------------------------------------------------------------------------------
+
+void cThreadPool::parallelFor(int a_begin, int a_end, int a_grain, const std::function<void(int, int)>& a_function)
+{
+    if (a_end <= a_begin)
+    {
+        return;
+    }
+
+    // nothing to share
+    int grain = std::max(1, a_grain);
+    int numThreads = getNumThreads();
+    if ((numThreads == 1) || (a_end - a_begin <= grain))
+    {
+        a_function(a_begin, a_end);
+        return;
+    }
+
+    // deal chunks round-robin
+    m_function = &a_function;
+    int numTasks = (a_end - a_begin + grain - 1) / grain;
+    m_numPending.store(numTasks, std::memory_order_relaxed);
+    for (int t = 0; t < numTasks; t++)
+    {
+        cTask task;
+        task.m_begin = a_begin + t * grain;
+        task.m_end = std::min(a_end, task.m_begin + grain);
+
+        cQueue* queue = m_queues[t % numThreads];
+        std::lock_guard<std::mutex> lock(queue->m_mutex);
+        queue->m_tasks.push_back(task);
+    }
+
+    // wake the workers
+    {
+        std::lock_guard<std::mutex> lock(m_wakeMutex);
+        m_generation.fetch_add(1, std::memory_order_release);
+    }
+    m_wake.notify_all();
+
+    // help, then wait for the chunks still running on other threads
+    runTasks(0);
+    while (m_numPending.load(std::memory_order_acquire) > 0)
+    {
+        std::this_thread::yield();
+    }
+    m_function = NULL;
+}
+
+//------------------------------------------------------------------------------
+
+void cThreadPool::workerLoop(int a_index)
+{
+    unsigned int seen = 0;
+    while (true)
+    {
+        // spin, then sleep, until the next loop is issued
+        int spin = 0;
+        while ((m_generation.load(std::memory_order_acquire) == seen) && (spin < C_SPIN_COUNT))
+        {
+            spin++;
+        }
+        if (m_generation.load(std::memory_order_acquire) == seen)
+        {
+            std::unique_lock<std::mutex> lock(m_wakeMutex);
+            m_wake.wait(lock, [&]() { return (m_generation.load(std::memory_order_acquire) != seen); });
+        }
+        seen = m_generation.load(std::memory_order_acquire);
+
+        if (m_quit.load(std::memory_order_acquire))
+        {
+            return;
+        }
+
+        runTasks(a_index);
+    }
+}
+
+//------------------------------------------------------------------------------
+
+void cThreadPool::runTasks(int a_index)
+{
+    cTask task;
+    while (popTask(a_index, task))
+    {
+        (*m_function)(task.m_begin, task.m_end);
+        m_numPending.fetch_sub(1, std::memory_order_release);
+    }
+}
+
+//------------------------------------------------------------------------------
+
+bool cThreadPool::popTask(int a_index, cTask& a_task)
+{
+    // own queue, most recently dealt chunk first
+    {
+        cQueue* queue = m_queues[a_index];
+        std::lock_guard<std::mutex> lock(queue->m_mutex);
+        if (!queue->m_tasks.empty())
+        {
+            a_task = queue->m_tasks.back();
+            queue->m_tasks.pop_back();
+            return (true);
+        }
+    }
+
+    // steal the oldest chunk of another thread
+    int numThreads = getNumThreads();
+    for (int k = 1; k < numThreads; k++)
+    {
+        cQueue* queue = m_queues[(a_index + k) % numThreads];
+        std::lock_guard<std::mutex> lock(queue->m_mutex);
+        if (!queue->m_tasks.empty())
+        {
+            a_task = queue->m_tasks.front();
+            queue->m_tasks.pop_front();
+            return (true);
+        }
+    }
+
+    return (false);
+}
+
+//------------------------------------------------------------------------------
+
+bool cPinCurrentThread(int a_core)
+{
+    if ((a_core < 0) || (a_core >= (int)std::thread::hardware_concurrency()) || (a_core >= 64))
+    {
+        return (false);
+    }
+#if defined(_WIN32)
+    return (SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)1 << a_core) != 0);
+#elif defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(a_core, &set);
+    return (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0);
+#else
+    // macOS only takes affinity hints
+    return (false);
+#endif
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//------------------------------------------------------------------------------
+// DECLARED TYPES
+//------------------------------------------------------------------------------
+
+// work-stealing pool for data parallel loops. parallelFor() cuts a range into
+// chunks that are dealt round-robin to one queue per thread; each thread
+// drains its own queue and then steals from the others, and the call returns
+// once every chunk has run, so consecutive calls are separated by a barrier.
+// the calling thread takes part in the work.
+class cThreadPool
+{
+public:
+
+    // constructor, a_numThreads counts the calling thread
+    cThreadPool(int a_numThreads);
+
+    // destructor, joins the workers
+    ~cThreadPool();
+
+    // number of threads taking part in a loop
+    int getNumThreads() const { return ((int)m_queues.size()); }
+
+    // call a_function(begin, end) on chunks of at most a_grain items covering
+    // [a_begin, a_end), returns when all chunks are done
+    void parallelFor(int a_begin, int a_end, int a_grain, const std::function<void(int, int)>& a_function);
+
+protected:
+
+    // chunk of a loop
+    struct cTask
+    {
+        int m_begin;
+        int m_end;
+    };
+
+    // task queue of one thread, on its own cache line
+    struct alignas(64) cQueue
+    {
+        std::mutex m_mutex;
+        std::deque<cTask> m_tasks;
+    };
+
+    // worker thread body
+    void workerLoop(int a_index);
+
+    // run tasks from the own queue, then stolen ones, until none is left
+    void runTasks(int a_index);
+
+    // take a task from the back of the own queue or the front of another one
+    bool popTask(int a_index, cTask& a_task);
+
+protected:
+
+    // worker threads (the calling thread is thread 0 and has no entry)
+    std::vector<std::thread> m_threads;
+
+    // one queue per thread
+    std::vector<cQueue*> m_queues;
+
+    // loop body of the current parallelFor()
+    const std::function<void(int, int)>* m_function;
+
+    // number of chunks not yet completed
+    std::atomic<int> m_numPending;
+
+    // incremented by every parallelFor() to wake the workers
+    std::atomic<unsigned int> m_generation;
+
+    // true when the workers must exit
+    std::atomic<bool> m_quit;
+
+    // sleeping workers wait here after spinning for a while
+    std::mutex m_wakeMutex;
+    std::condition_variable m_wake;
+};
+
+//------------------------------------------------------------------------------
+// DECLARED FUNCTIONS
+//------------------------------------------------------------------------------
+
+// pin the calling thread to core a_core, returns false where threads cannot
+// be pinned (macOS) or the core does not exist
+bool cPinCurrentThread(int a_core);
@@ -0,0 +1,103 @@
+//------------------------------------------------------------------------------
+#include "toolDevice.h"
+//------------------------------------------------------------------------------
+#include <cstdio>
+//------------------------------------------------------------------------------
+using namespace chai3d;
+//------------------------------------------------------------------------------
+
+cToolDevice::cToolDevice(int a_index) : m_timings(1000000)
+{
+    m_index = a_index;
+    m_workspaceScaleFactor = 1.0;
+    m_offset.zero();
+    m_maxProxyStiffness = 0.0;
+    m_object = NULL;
+    m_tool.m_pos.zero();
+    m_tool.m_rot.identity();
+    m_force.zero();
+    m_torque.zero();
+    m_previousForce.zero();
+    m_currentForce.zero();
+    m_thread = NULL;
+    m_core = -1;
+}
+
+//------------------------------------------------------------------------------
+
+cToolDevice::~cToolDevice()
+{
+    delete m_thread;
+}
+
+//------------------------------------------------------------------------------
+
+void cToolDevice::open(cGenericHapticDevicePtr a_device, double a_cursorRadius, const cVector3d& a_offset)
+{
+    m_device = a_device;
+    m_info = m_device->getSpecifications();
+
+    // open a connection to the device and calibrate it (if necessary)
+    m_device->open();
+    m_device->calibrate();
+
+    // if the device has a gripper, enable the gripper to simulate a user switch
+    m_device->setEnableGripperUserSwitch(true);
+
+    // scale factor between the physical workspace of the device and the
+    // virtual workspace of the tool
+    m_workspaceScaleFactor = a_cursorRadius / m_info.m_workspaceRadius;
+    m_offset = a_offset;
+    m_tool.m_pos = m_offset;
+
+    // stiffest contact the proxy may render on the device
+    m_maxProxyStiffness = m_info.m_maxLinearStiffness / m_workspaceScaleFactor;
+}
+
+//------------------------------------------------------------------------------
+
+void cToolDevice::close()
+{
+    if (m_device != NULL)
+    {
+        m_device->close();
+    }
+}
+
+//------------------------------------------------------------------------------
+
+void cToolDevice::readPose(cToolPose& a_pose, cVector3d& a_devicePos)
+{
+    m_device->getPosition(a_devicePos);
+    m_device->getRotation(a_pose.m_rot);
+    a_pose.m_pos = m_offset + m_workspaceScaleFactor * a_devicePos;
+    if (m_object != NULL)
+    {
+        m_object->setLocalPos(a_pose.m_pos);
+        m_object->setLocalRot(a_pose.m_rot);
+    }
+}
+
+//------------------------------------------------------------------------------
+
+void cToolDevice::resetBuffers()
+{
+    for (int i = 0; i < 3; i++)
+    {
+        m_pose.getBuffer(i).m_pos = m_offset;
+        m_pose.getBuffer(i).m_rot.identity();
+        m_proxy.getBuffer(i).m_active = false;
+        m_proxy.getBuffer(i).m_tick = 0;
+    }
+}
+
+//------------------------------------------------------------------------------
+
+std::string cToolDevice::getSummary()
+{
+    char text[64];
+    snprintf(text, sizeof(text), "device %d: %.0f Hz", m_index, m_freqCounter.getFrequency());
+    return (std::string(text) + (m_core >= 0 ? " on core " + std::to_string(m_core) : std::string("")) +
+        "  interval " + m_timings.getHistogram(C_PHASE_INTERVAL).getSummary() +
+        "  tick " + m_timings.getHistogram(C_PHASE_TICK).getSummary());
+}
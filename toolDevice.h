@@ -0,0 +1,94 @@
+#pragma once
+
+#include "chai3d.h"
+#include "clothContact.h"
+#include "contactProxy.h"
+#include "latencyHistogram.h"
+#include "toolShape.h"
+#include "tripleBuffer.h"
+
+#include <string>
+
+//------------------------------------------------------------------------------
+// DECLARED TYPES
+//------------------------------------------------------------------------------
+
+// haptic device driving one tool on the shared cloth. the physics thread keeps
+// the contact set of every tool; in multi-rate mode each device also has its
+// own haptics thread, which publishes the tool pose and renders the contact
+// proxy published back by the physics thread. both hand-overs go through
+// triple buffers, so a device never waits for the solver or another device.
+class cToolDevice
+{
+public:
+
+    // constructor
+    cToolDevice(int a_index);
+
+    // destructor
+    ~cToolDevice();
+
+    // open and calibrate a_device, its workspace is mapped to a sphere of
+    // radius a_cursorRadius around a_offset in the world [m]
+    void open(chai3d::cGenericHapticDevicePtr a_device, double a_cursorRadius, const chai3d::cVector3d& a_offset);
+
+    // close the device
+    void close();
+
+    // tool pose in world coordinates, a_devicePos is the raw device position
+    void readPose(cToolPose& a_pose, chai3d::cVector3d& a_devicePos);
+
+    // reset the buffers shared with the physics thread, before threads start
+    void resetBuffers();
+
+    // rate, tick interval and tick duration on one line
+    std::string getSummary();
+
+public:
+
+    // index of the device
+    int m_index;
+
+    // device and its specifications
+    chai3d::cGenericHapticDevicePtr m_device;
+    chai3d::cHapticDeviceInfo m_info;
+
+    // scale from device to world coordinates, and world position of the
+    // workspace center
+    double m_workspaceScaleFactor;
+    chai3d::cVector3d m_offset;
+
+    // stiffest contact the proxy may render on the device [N/m]
+    double m_maxProxyStiffness;
+
+    // tool drawn at the device pose, may be NULL
+    chai3d::cMesh* m_object;
+
+    // contact between the tool and the cloth (physics thread)
+    cToolContact m_contact;
+
+    // tool pose used by the last physics step, and the force and torque it
+    // returned (physics thread)
+    cToolPose m_tool;
+    chai3d::cVector3d m_force;
+    chai3d::cVector3d m_torque;
+
+    // force of the last two fixed steps, blended for the contact proxy
+    // (physics thread, multi-rate mode)
+    chai3d::cVector3d m_previousForce;
+    chai3d::cVector3d m_currentForce;
+
+    // tool pose published by the haptics thread to the physics thread
+    cTripleBuffer<cToolPose> m_pose;
+
+    // local contact model published by the physics thread to the haptics thread
+    cTripleBuffer<cContactProxy> m_proxy;
+
+    // per phase latency and rate of the haptics thread of the device
+    cHapticTimings m_timings;
+    chai3d::cFrequencyCounter m_freqCounter;
+
+    // haptics thread, and the core it is pinned to (-1 if none)
+    chai3d::cThread* m_thread;
+    int m_core;
+};
@@ -0,0 +1,159 @@
+//------------------------------------------------------------------------------
+#include "toolShape.h"
+//------------------------------------------------------------------------------
+#include <algorithm>
+//------------------------------------------------------------------------------
+using namespace chai3d;
+//------------------------------------------------------------------------------
+
+cToolShape::cToolShape()
+{
+}
+
+//------------------------------------------------------------------------------
+
+void cToolShape::addSphere(const cVector3d& a_center, double a_radius)
+{
+    cToolPrimitive primitive;
+    primitive.m_type = C_TOOL_SPHERE;
+    primitive.m_pos = a_center;
+    primitive.m_end = a_center;
+    primitive.m_halfSize.zero();
+    primitive.m_rot.identity();
+    primitive.m_radius = a_radius;
+    m_primitives.push_back(primitive);
+}
+
+//------------------------------------------------------------------------------
+
+void cToolShape::addCapsule(const cVector3d& a_end0, const cVector3d& a_end1, double a_radius)
+{
+    cToolPrimitive primitive;
+    primitive.m_type = C_TOOL_CAPSULE;
+    primitive.m_pos = a_end0;
+    primitive.m_end = a_end1;
+    primitive.m_halfSize.zero();
+    primitive.m_rot.identity();
+    primitive.m_radius = a_radius;
+    m_primitives.push_back(primitive);
+}
+
+//------------------------------------------------------------------------------
+
+void cToolShape::addBox(const cVector3d& a_center, const cVector3d& a_halfSize, const cMatrix3d& a_rot)
+{
+    cToolPrimitive primitive;
+    primitive.m_type = C_TOOL_BOX;
+    primitive.m_pos = a_center;
+    primitive.m_end = a_center;
+    primitive.m_halfSize = a_halfSize;
+    primitive.m_rot = a_rot;
+    primitive.m_radius = 0.0;
+    m_primitives.push_back(primitive);
+}
+
+//------------------------------------------------------------------------------
+
+double cToolShape::getFeatureSize(double a_margin) const
+{
+    double size = 0.0;
+    for (size_t i = 0; i < m_primitives.size(); i++)
+    {
+        const cToolPrimitive& primitive = m_primitives[i];
+        double thickness = primitive.m_radius;
+        if (primitive.m_type == C_TOOL_BOX)
+        {
+            thickness += std::min(primitive.m_halfSize(0), std::min(primitive.m_halfSize(1), primitive.m_halfSize(2)));
+        }
+        size = std::max(size, thickness);
+    }
+    return (size + a_margin);
+}
+
+//------------------------------------------------------------------------------
+
+void cToolShape::createMesh(cMesh* a_mesh) const
+{
+    for (size_t i = 0; i < m_primitives.size(); i++)
+    {
+        const cToolPrimitive& primitive = m_primitives[i];
+        if (primitive.m_type == C_TOOL_SPHERE)
+        {
+            cCreateSphere(a_mesh, primitive.m_radius, 32, 32, primitive.m_pos);
+        }
+        else if (primitive.m_type == C_TOOL_CAPSULE)
+        {
+            // cylinders are built along z from their base, turn z onto the axis
+            cVector3d axis = primitive.m_end - primitive.m_pos;
+            double length = axis.length();
+            cMatrix3d rot;
+            if (length > 0.0)
+            {
+                cVector3d z = axis / length;
+                cVector3d x = cCross((fabs(z(0)) < 0.9) ? cVector3d(1.0, 0.0, 0.0) : cVector3d(0.0, 1.0, 0.0), z);
+                x.normalize();
+                rot.setCol(x, cCross(z, x), z);
+                cCreateCylinder(a_mesh, length, primitive.m_radius, 32, 1, 1, false, false, primitive.m_pos, rot);
+            }
+            cCreateSphere(a_mesh, primitive.m_radius, 32, 32, primitive.m_pos);
+            cCreateSphere(a_mesh, primitive.m_radius, 32, 32, primitive.m_end);
+        }
+        else
+        {
+            cCreateBox(a_mesh, 2.0 * primitive.m_halfSize(0), 2.0 * primitive.m_halfSize(1), 2.0 * primitive.m_halfSize(2),
+                primitive.m_pos, primitive.m_rot);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+
+bool cCreateToolShape(const std::string& a_name, double a_size, cToolShape& a_shape)
+{
+    a_shape.clear();
+
+    // the scene is y up, tools reach down to the device position
+    if (a_name == "sphere")
+    {
+        a_shape.addSphere(cVector3d(0.0, 0.0, 0.0), a_size);
+    }
+    else if (a_name == "stylus")
+    {
+        a_shape.addCapsule(cVector3d(0.0, 0.0, 0.0), cVector3d(0.0, 2.0 * a_size, 0.0), 0.25 * a_size);
+    }
+    else if (a_name == "finger")
+    {
+        // spheres thickening from the tip
+        for (int k = 0; k < 8; k++)
+        {
+            a_shape.addSphere(cVector3d(0.0, 0.2 * a_size * k, 0.0), (0.2 + 0.015 * k) * a_size);
+        }
+    }
+    else if (a_name == "paddle")
+    {
+        a_shape.addBox(cVector3d(0.0, 0.0, 0.0), cVector3d(a_size, 0.1 * a_size, 0.6 * a_size));
+    }
+    else if (a_name == "hand")
+    {
+        // palm, four fingers along x and a thumb, 30 primitives
+        a_shape.addBox(cVector3d(0.0, 0.0, 0.0), cVector3d(0.5 * a_size, 0.1 * a_size, 0.45 * a_size));
+        for (int f = 0; f < 4; f++)
+        {
+            double z = (-0.33 + 0.22 * f) * a_size;
+            for (int k = 0; k < 6; k++)
+            {
+                a_shape.addSphere(cVector3d((0.6 + 0.18 * k) * a_size, 0.0, z), 0.1 * a_size);
+            }
+        }
+        cVector3d thumb = cNormalize(cVector3d(-0.5, 0.0, -1.0));
+        for (int k = 0; k < 5; k++)
+        {
+            a_shape.addSphere(cVector3d(0.0, 0.0, -0.45 * a_size) + ((0.1 + 0.18 * k) * a_size) * thumb, 0.1 * a_size);
+        }
+    }
+    else
+    {
+        return (false);
+    }
+    return (true);
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include "chai3d.h"
+
+#include <string>
+#include <vector>
+
+//------------------------------------------------------------------------------
+// DECLARED TYPES
+//------------------------------------------------------------------------------
+
+// kinds of contact primitives
+enum cToolPrimitiveType
+{
+    C_TOOL_SPHERE,
+    C_TOOL_CAPSULE,
+    C_TOOL_BOX
+};
+
+//------------------------------------------------------------------------------
+
+// contact primitive of a tool, given in the tool frame
+struct cToolPrimitive
+{
+    // kind of primitive
+    cToolPrimitiveType m_type;
+
+    // sphere center, first end of a capsule or box center [m]
+    chai3d::cVector3d m_pos;
+
+    // second end of a capsule [m]
+    chai3d::cVector3d m_end;
+
+    // half sizes of a box along its axes [m]
+    chai3d::cVector3d m_halfSize;
+
+    // axes of a box
+    chai3d::cMatrix3d m_rot;
+
+    // radius of a sphere or capsule, rounding of a box [m]
+    double m_radius;
+};
+
+//------------------------------------------------------------------------------
+
+// position and orientation of a tool in world coordinates
+struct cToolPose
+{
+    chai3d::cVector3d m_pos;
+    chai3d::cMatrix3d m_rot;
+};
+
+//------------------------------------------------------------------------------
+
+// tool made of spheres, capsules and boxes, moving with the device. the
+// origin of the tool frame is the device position.
+class cToolShape
+{
+public:
+
+    // constructor
+    cToolShape();
+
+    // remove all primitives
+    void clear() { m_primitives.clear(); }
+
+    // add a sphere of radius a_radius at a_center
+    void addSphere(const chai3d::cVector3d& a_center, double a_radius);
+
+    // add a capsule of radius a_radius around the segment [a_end0, a_end1]
+    void addCapsule(const chai3d::cVector3d& a_end0, const chai3d::cVector3d& a_end1, double a_radius);
+
+    // add a box of half sizes a_halfSize and axes a_rot around a_center
+    void addBox(const chai3d::cVector3d& a_center, const chai3d::cVector3d& a_halfSize,
+        const chai3d::cMatrix3d& a_rot = chai3d::cIdentity3d());
+
+    // number of primitives
+    int getNumPrimitives() const { return ((int)m_primitives.size()); }
+
+    // primitive a_index
+    const cToolPrimitive& getPrimitive(int a_index) const { return (m_primitives[a_index]); }
+
+    // largest half thickness of the primitives grown by a_margin, the size of
+    // the broad phase cells [m]
+    double getFeatureSize(double a_margin) const;
+
+    // add triangles of all primitives to a_mesh, in the tool frame
+    void createMesh(chai3d::cMesh* a_mesh) const;
+
+protected:
+
+    // primitives in the tool frame
+    std::vector<cToolPrimitive> m_primitives;
+};
+
+//------------------------------------------------------------------------------
+// DECLARED FUNCTIONS
+//------------------------------------------------------------------------------
+
+// fill a_shape with the preset a_name ("sphere", "stylus", "finger", "paddle"
+// or "hand") scaled to a_size [m], returns false for an unknown name
+bool cCreateToolShape(const std::string& a_name, double a_size, cToolShape& a_shape);
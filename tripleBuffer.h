@@ -0,0 +1,65 @@
+#pragma once
+
+#include <atomic>
+
+//------------------------------------------------------------------------------
+// DECLARED TYPES
+//------------------------------------------------------------------------------
+
+// lock-free triple buffer between one writer thread and one reader thread.
+// the writer fills the write buffer and publishes it with a single atomic
+// exchange, the reader picks up the newest published buffer without ever
+// blocking the writer and never sees a partially written buffer.
+template <class T>
+class cTripleBuffer
+{
+public:
+
+    // constructor
+    cTripleBuffer() : m_middle(1), m_write(0), m_read(2) {}
+
+    // direct access to buffer a_index (0 to 2), only for initialization
+    T& getBuffer(int a_index) { return m_buffers[a_index]; }
+
+    // buffer currently owned by the writer
+    T& getWriteBuffer() { return m_buffers[m_write]; }
+
+    // publish the write buffer, the writer then owns the previous middle buffer
+    void publish()
+    {
+        int previous = m_middle.exchange(m_write | C_FRESH, std::memory_order_acq_rel);
+        m_write = previous & C_INDEX;
+    }
+
+    // acquire the newest published buffer, returns false if nothing new was published
+    bool acquire()
+    {
+        if ((m_middle.load(std::memory_order_relaxed) & C_FRESH) == 0)
+        {
+            return (false);
+        }
+        int previous = m_middle.exchange(m_read, std::memory_order_acq_rel);
+        m_read = previous & C_INDEX;
+        return (true);
+    }
+
+    // buffer currently owned by the reader
+    const T& getReadBuffer() const { return m_buffers[m_read]; }
+
+protected:
+
+    // middle buffer index and flag set when it holds an unread frame
+    enum { C_INDEX = 3, C_FRESH = 4 };
+
+    // the three buffers
+    T m_buffers[3];
+
+    // buffer shared between writer and reader
+    std::atomic<int> m_middle;
+
+    // buffer owned by the writer
+    int m_write;
+
+    // buffer owned by the reader
+    int m_read;
+};
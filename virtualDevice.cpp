@@ -0,0 +1,177 @@
+//------------------------------------------------------------------------------
+#include "virtualDevice.h"
+//------------------------------------------------------------------------------
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+//------------------------------------------------------------------------------
+using namespace chai3d;
+//------------------------------------------------------------------------------
+
+cScriptedHapticDevice::cScriptedHapticDevice()
+{
+    m_time = 0.0;
+    m_deviceReady = false;
+    m_deviceAvailable = true;
+
+    m_specifications.m_modelName = "scripted device";
+    m_specifications.m_workspaceRadius = 0.2;       // [m]
+    m_specifications.m_maxLinearForce = 10.0;       // [N]
+    m_specifications.m_maxLinearStiffness = 2000.0; // [N/m]
+    m_specifications.m_sensedRotation = false;
+}
+
+//------------------------------------------------------------------------------
+
+bool cScriptedHapticDevice::loadTrajectory(const std::string& a_filename)
+{
+    std::ifstream file(a_filename.c_str());
+    if (!file)
+    {
+        return (C_ERROR);
+    }
+
+    m_sampleTime.clear();
+    m_samplePos.clear();
+
+    std::string line;
+    while (std::getline(file, line))
+    {
+        std::istringstream input(line);
+        double t, x, y, z;
+        if (input >> t >> x >> y >> z)
+        {
+            m_sampleTime.push_back(t);
+            m_samplePos.push_back(cVector3d(x, y, z));
+        }
+    }
+
+    return (!m_sampleTime.empty());
+}
+
+//------------------------------------------------------------------------------
+
+bool cScriptedHapticDevice::getPosition(cVector3d& a_position)
+{
+    if (m_sampleTime.empty())
+    {
+        a_position = getParametricPosition(m_time);
+        return (C_SUCCESS);
+    }
+
+    // hold first and last samples outside of the recorded time range
+    if (m_time <= m_sampleTime.front())
+    {
+        a_position = m_samplePos.front();
+        return (C_SUCCESS);
+    }
+    if (m_time >= m_sampleTime.back())
+    {
+        a_position = m_samplePos.back();
+        return (C_SUCCESS);
+    }
+
+    // linear interpolation between the surrounding samples
+    size_t i = std::upper_bound(m_sampleTime.begin(), m_sampleTime.end(), m_time) - m_sampleTime.begin();
+    double t0 = m_sampleTime[i - 1];
+    double t1 = m_sampleTime[i];
+    double s = (t1 > t0) ? (m_time - t0) / (t1 - t0) : 0.0;
+    a_position = m_samplePos[i - 1] + s * (m_samplePos[i] - m_samplePos[i - 1]);
+
+    return (C_SUCCESS);
+}
+
+//------------------------------------------------------------------------------
+
+bool cScriptedHapticDevice::setForceAndTorqueAndGripperForce(const cVector3d& a_force,
+    const cVector3d& /*a_torque*/,
+    double /*a_gripperForce*/)
+{
+    m_lastForce = a_force;
+    return (C_SUCCESS);
+}
+
+//------------------------------------------------------------------------------
+
+cVector3d cScriptedHapticDevice::getParametricPosition(double a_time) const
+{
+    const double descentTime = 2.0;     // [s]
+    const double startHeight = 0.1;     // [m]
+    const double pressHeight = -0.25;   // [m]
+    const double circleRadius = 0.15;   // [m]
+    const double circlePeriod = 4.0;    // [s]
+
+    // move down from above the cloth center
+    if (a_time < descentTime)
+    {
+        double s = a_time / descentTime;
+        return (cVector3d(0.0, startHeight + s * (pressHeight - startHeight), 0.0));
+    }
+
+    // then drag the cloth along a circle, starting from the center
+    double t = a_time - descentTime;
+    double radius = cMin(1.0, t) * circleRadius;
+    double angle = C_TWO_PI * t / circlePeriod;
+    return (cVector3d(radius * cos(angle), pressHeight, radius * sin(angle)));
+}
+
+//------------------------------------------------------------------------------
+
+cReplayHapticDevice::cReplayHapticDevice(const cSessionReader& a_session) : m_session(a_session)
+{
+    m_index = 0;
+    m_deviceReady = false;
+    m_deviceAvailable = true;
+
+    const cSessionHeader& header = a_session.getHeader();
+    m_specifications.m_modelName = "replay device";
+    m_specifications.m_workspaceRadius = header.m_workspaceRadius;
+    m_specifications.m_maxLinearForce = header.m_maxLinearForce;
+    m_specifications.m_maxLinearStiffness = header.m_maxLinearStiffness;
+    m_specifications.m_sensedRotation = true;
+}
+
+//------------------------------------------------------------------------------
+
+bool cReplayHapticDevice::getPosition(cVector3d& a_position)
+{
+    // hold the last recorded position once the session is over
+    unsigned long long n = m_session.getNumRecords();
+    if (n == 0)
+    {
+        a_position.zero();
+        return (C_SUCCESS);
+    }
+    const cSessionRecord& record = m_session.getRecords()[cMin(m_index, n - 1)];
+    a_position.set(record.m_pos[0], record.m_pos[1], record.m_pos[2]);
+    return (C_SUCCESS);
+}
+
+//------------------------------------------------------------------------------
+
+bool cReplayHapticDevice::getRotation(cMatrix3d& a_rotation)
+{
+    // hold the last recorded orientation once the session is over
+    unsigned long long n = m_session.getNumRecords();
+    if (n == 0)
+    {
+        a_rotation.identity();
+        return (C_SUCCESS);
+    }
+    const double* rot = m_session.getRecords()[cMin(m_index, n - 1)].m_rot;
+    a_rotation.set(rot[0], rot[1], rot[2],
+                   rot[3], rot[4], rot[5],
+                   rot[6], rot[7], rot[8]);
+    return (C_SUCCESS);
+}
+
+//------------------------------------------------------------------------------
+
+bool cReplayHapticDevice::setForceAndTorqueAndGripperForce(const cVector3d& a_force,
+    const cVector3d& a_torque,
+    double /*a_gripperForce*/)
+{
+    m_lastForce = a_force;
+    m_lastTorque = a_torque;
+    return (C_SUCCESS);
+}
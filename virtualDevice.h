@@ -0,0 +1,128 @@
+#pragma once
+
+#include "chai3d.h"
+#include "sessionLog.h"
+
+#include <string>
+#include <vector>
+
+//------------------------------------------------------------------------------
+// DECLARED TYPES
+//------------------------------------------------------------------------------
+
+class cScriptedHapticDevice;
+typedef std::shared_ptr<cScriptedHapticDevice> cScriptedHapticDevicePtr;
+
+class cReplayHapticDevice;
+typedef std::shared_ptr<cReplayHapticDevice> cReplayHapticDevicePtr;
+
+//------------------------------------------------------------------------------
+
+// virtual haptic device that follows a scripted trajectory instead of a
+// physical device. positions are given in device coordinates, with the
+// default 0.2 m workspace they map 1:1 to world coordinates.
+class cScriptedHapticDevice : public chai3d::cGenericHapticDevice
+{
+public:
+
+    // constructor
+    cScriptedHapticDevice();
+
+    // shared pointer factory
+    static cScriptedHapticDevicePtr create() { return (std::make_shared<cScriptedHapticDevice>()); }
+
+    // load a trajectory from a text file with one "t x y z" sample per line
+    bool loadTrajectory(const std::string& a_filename);
+
+    // advance the script time by a_dt seconds
+    void advance(double a_dt) { m_time += a_dt; }
+
+    // current script time
+    double getTime() const { return m_time; }
+
+    // last force sent to the device
+    const chai3d::cVector3d& getLastForce() const { return m_lastForce; }
+
+public:
+
+    // cGenericHapticDevice interface
+    virtual bool open() { m_deviceReady = true; return (C_SUCCESS); }
+    virtual bool close() { m_deviceReady = false; return (C_SUCCESS); }
+    virtual bool calibrate(bool /*a_forceCalibration*/ = false) { return (C_SUCCESS); }
+    virtual bool getPosition(chai3d::cVector3d& a_position);
+    virtual bool getRotation(chai3d::cMatrix3d& a_rotation) { a_rotation.identity(); return (C_SUCCESS); }
+    virtual bool setForceAndTorqueAndGripperForce(const chai3d::cVector3d& a_force,
+        const chai3d::cVector3d& a_torque,
+        double a_gripperForce);
+
+protected:
+
+    // default trajectory: move down into the cloth, then circle over it
+    chai3d::cVector3d getParametricPosition(double a_time) const;
+
+protected:
+
+    // script time [s]
+    double m_time;
+
+    // recorded trajectory, empty for the parametric trajectory
+    std::vector<double> m_sampleTime;
+    std::vector<chai3d::cVector3d> m_samplePos;
+
+    // last commanded force
+    chai3d::cVector3d m_lastForce;
+};
+
+//------------------------------------------------------------------------------
+
+// virtual haptic device that plays back the positions of a recorded session,
+// with the specifications of the device it was recorded with
+class cReplayHapticDevice : public chai3d::cGenericHapticDevice
+{
+public:
+
+    // constructor, a_session must stay open while the device is used
+    cReplayHapticDevice(const cSessionReader& a_session);
+
+    // shared pointer factory
+    static cReplayHapticDevicePtr create(const cSessionReader& a_session) { return (std::make_shared<cReplayHapticDevice>(a_session)); }
+
+    // move on to the next recorded tick
+    void advance() { m_index++; }
+
+    // index of the current tick
+    unsigned long long getIndex() const { return m_index; }
+
+    // true once all ticks have been played
+    bool isFinished() const { return (m_index >= m_session.getNumRecords()); }
+
+    // last force sent to the device
+    const chai3d::cVector3d& getLastForce() const { return m_lastForce; }
+
+    // last torque sent to the device
+    const chai3d::cVector3d& getLastTorque() const { return m_lastTorque; }
+
+public:
+
+    // cGenericHapticDevice interface
+    virtual bool open() { m_deviceReady = true; return (C_SUCCESS); }
+    virtual bool close() { m_deviceReady = false; return (C_SUCCESS); }
+    virtual bool calibrate(bool /*a_forceCalibration*/ = false) { return (C_SUCCESS); }
+    virtual bool getPosition(chai3d::cVector3d& a_position);
+    virtual bool getRotation(chai3d::cMatrix3d& a_rotation);
+    virtual bool setForceAndTorqueAndGripperForce(const chai3d::cVector3d& a_force,
+        const chai3d::cVector3d& a_torque,
+        double a_gripperForce);
+
+protected:
+
+    // recorded session
+    const cSessionReader& m_session;
+
+    // current tick
+    unsigned long long m_index;
+
+    // last commanded force and torque
+    chai3d::cVector3d m_lastForce;
+    chai3d::cVector3d m_lastTorque;
+};